@@ -0,0 +1,95 @@
+#include <libteddy/core.hpp>
+#include <chrono>
+#include <nanobench/nanobench.h>
+#include <iostream>
+#include <random>
+#include <vector>
+
+char const* unit_str(std::chrono::nanoseconds) { return "ns"; }
+char const* unit_str(std::chrono::microseconds){ return "µs"; }
+char const* unit_str(std::chrono::milliseconds){ return "ms"; }
+
+/**
+ *  \brief Creates random clauses (disjunctions of literals).
+ */
+auto make_clauses (
+    teddy::bdd_manager& manager,
+    std::ranlux48& rng,
+    int clauseCount,
+    int literalCount
+) -> std::vector<teddy::bdd_manager::diagram_t>
+{
+    using diagram_t = teddy::bdd_manager::diagram_t;
+    std::uniform_int_distribution<int> varDist(0, manager.get_var_count() - 1);
+    std::uniform_int_distribution<int> valueDist(0, 1);
+    std::vector<diagram_t> clauses;
+    for (int ci = 0; ci < clauseCount; ++ci)
+    {
+        std::vector<diagram_t> literals;
+        for (int i = 0; i < literalCount; ++i)
+        {
+            int const index = varDist(rng);
+            literals.push_back(
+                valueDist(rng) == 1 ? manager.variable(index)
+                                    : manager.variable_not(index)
+            );
+        }
+        clauses.push_back(manager.left_fold<teddy::ops::OR>(literals));
+    }
+    return clauses;
+}
+
+/**
+ *  \brief Compares conjunction of random clauses computed by folds
+ *  and by the runtime-arity apply_n.
+ */
+auto main() -> int
+{
+    namespace ch = std::chrono;
+    using time_unit = ch::milliseconds;
+
+    char const* const Sep      = "\t";
+    char const* const Eol      = "\n";
+    int constexpr Seed         = 5'126;
+    int constexpr VarCount     = 40;
+    int constexpr LiteralCount = 3;
+
+    std::ranlux48 rng(Seed);
+
+    std::cout << "clauses"    << Sep
+              << "method"     << Sep
+              << "time["      << unit_str(time_unit()) << "]" << Sep
+              << "node-count" << Eol;
+
+    for (int const clauseCount : {10, 100, 1'000})
+    {
+        teddy::bdd_manager seed(VarCount, 1'000'000);
+        auto const clauses
+            = make_clauses(seed, rng, clauseCount, LiteralCount);
+
+        for (char const* const method : {"left-fold", "tree-fold", "apply-n"})
+        {
+            teddy::bdd_manager manager(VarCount, 1'000'000);
+            std::vector<teddy::bdd_manager::diagram_t> copy;
+            for (auto const& clause : clauses)
+            {
+                copy.push_back(manager.transfer(seed, clause));
+            }
+            auto const start = ch::high_resolution_clock::now();
+            auto const conj
+                = method[0] == 'l'
+                    ? manager.left_fold<teddy::ops::AND>(copy)
+                : method[0] == 't'
+                    ? manager.tree_fold<teddy::ops::AND>(copy)
+                    : manager.apply_n<teddy::ops::AND>(copy);
+            ankerl::nanobench::doNotOptimizeAway(conj);
+            auto const end  = ch::high_resolution_clock::now();
+            auto const time = ch::duration_cast<time_unit>(end - start);
+
+            std::cout << clauseCount << Sep
+                      << method << Sep
+                      << time.count() << Sep
+                      << manager.get_node_count(conj) << Eol;
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#include "cpp_source.hpp"
+#include <chrono>
+#include <cmath>
+#include <nanobench/nanobench.h>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Defined in the source generated by cpp-source-gen.
+extern int (*const generated_functions[])(int const*);
+extern double (*const generated_availabilities[])(double const* const*, int);
+
+char const* unit_str(std::chrono::nanoseconds) { return "ns"; }
+char const* unit_str(std::chrono::microseconds){ return "µs"; }
+char const* unit_str(std::chrono::milliseconds){ return "ms"; }
+
+/**
+ *  \brief Compares functions generated by \c to_cpp_source with
+ *  \c evaluate and \c calculate_availability and measures evaluation
+ *  time of both. Returns non-zero if the results differ.
+ */
+auto main() -> int
+{
+    namespace ch = std::chrono;
+    using time_unit = ch::microseconds;
+
+    char const* const Sep         = "\t";
+    char const* const Eol         = "\n";
+    int constexpr ReplCount       = 3;
+    int constexpr AssignmentCount = 1'000'000;
+    int const StateCount          = cpp_source::StateCount;
+    int const VarCount            = cpp_source::VarCount;
+
+    std::ranlux48 valueRng(cpp_source::Seed + 1);
+    std::uniform_int_distribution<int> valueDist(0, StateCount - 1);
+    std::vector<std::vector<int>> assignments(AssignmentCount);
+    for (std::vector<int>& values : assignments)
+    {
+        values.resize((size_t)VarCount);
+        for (int& value : values)
+        {
+            value = valueDist(valueRng);
+        }
+    }
+
+    // Random component state probabilities.
+    std::uniform_real_distribution<double> probDist(0.0, 1.0);
+    std::vector<std::vector<double>> probs((size_t)VarCount);
+    std::vector<double const*> probPtrs;
+    for (std::vector<double>& ps : probs)
+    {
+        double sum = 0;
+        for (int k = 0; k < StateCount; ++k)
+        {
+            ps.push_back(probDist(valueRng));
+            sum += ps.back();
+        }
+        for (double& p : ps)
+        {
+            p /= sum;
+        }
+        probPtrs.push_back(ps.data());
+    }
+
+    cpp_source::manager_t manager(VarCount, 1'000'000);
+    auto const diagrams = cpp_source::make_diagrams(manager);
+
+    std::cout << "diagram-id" << Sep
+              << "node-count" << Sep
+              << "evaluate["  << unit_str(time_unit()) << "]" << Sep
+              << "generated[" << unit_str(time_unit()) << "]" << Sep
+              << "relative"   << Eol;
+
+    int mismatchCount = 0;
+    for (int diagramId = 0; diagramId < cpp_source::DiagramCount; ++diagramId)
+    {
+        auto const& diagram  = diagrams[(size_t)diagramId];
+        auto const nodeCount = manager.get_node_count(diagram);
+        auto const generated = generated_functions[diagramId];
+        std::vector<int> expected(AssignmentCount);
+        std::vector<int> actual(AssignmentCount);
+
+        for (int state = 1; state < StateCount; ++state)
+        {
+            double const expectedA
+                = manager.calculate_availability(state, probs, diagram);
+            double const actualA
+                = generated_availabilities[diagramId](probPtrs.data(), state);
+            if (std::abs(expectedA - actualA) > 1e-9)
+            {
+                std::cerr << "availability mismatch: " << expectedA
+                          << " != " << actualA << Eol;
+                ++mismatchCount;
+            }
+        }
+
+        for (int repl = 0; repl < ReplCount; ++repl)
+        {
+            std::cout << diagramId << Sep
+                      << nodeCount << Sep;
+
+            time_unit timeEvaluate  = time_unit::zero();
+            time_unit timeGenerated = time_unit::zero();
+
+            // evaluate
+            {
+                auto const start = ch::high_resolution_clock::now();
+                for (int i = 0; i < AssignmentCount; ++i)
+                {
+                    expected[(size_t)i] = manager.evaluate(
+                        diagram,
+                        assignments[(size_t)i]
+                    );
+                }
+                ankerl::nanobench::doNotOptimizeAway(expected);
+                auto const end = ch::high_resolution_clock::now();
+                timeEvaluate   = ch::duration_cast<time_unit>(end - start);
+                std::cout << timeEvaluate.count() << Sep;
+            }
+
+            // generated function
+            {
+                auto const start = ch::high_resolution_clock::now();
+                for (int i = 0; i < AssignmentCount; ++i)
+                {
+                    actual[(size_t)i]
+                        = generated(assignments[(size_t)i].data());
+                }
+                ankerl::nanobench::doNotOptimizeAway(actual);
+                auto const end = ch::high_resolution_clock::now();
+                timeGenerated  = ch::duration_cast<time_unit>(end - start);
+                std::cout << timeGenerated.count() << Sep;
+            }
+
+            double const relative =
+                static_cast<double>(timeGenerated.count()) /
+                static_cast<double>(timeEvaluate.count());
+            std::cout << relative << Eol;
+
+            if (expected != actual)
+            {
+                std::cerr << "evaluate mismatch" << Eol;
+                ++mismatchCount;
+            }
+        }
+    }
+
+    return mismatchCount == 0 ? 0 : 1;
+}
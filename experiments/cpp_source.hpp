@@ -0,0 +1,47 @@
+#ifndef LIBTEDDY_EXPERIMENTS_CPP_SOURCE_HPP
+#define LIBTEDDY_EXPERIMENTS_CPP_SOURCE_HPP
+
+#include <libteddy/core.hpp>
+#include <libteddy/reliability.hpp>
+#include <libtsl/expressions.hpp>
+#include <libtsl/generators.hpp>
+#include <random>
+#include <vector>
+
+/**
+ *  \brief Diagrams shared by the source generator (cpp-source-gen)
+ *  and the benchmark (cpp-source). Both programs create them from
+ *  the same seed so the benchmark can compare the generated functions
+ *  with the diagrams they were generated from.
+ */
+namespace cpp_source
+{
+int constexpr DiagramCount = 3;
+int constexpr StateCount   = 3;
+int constexpr VarCount     = 15;
+int constexpr TermCount    = 20;
+int constexpr TermSize     = 5;
+int constexpr Seed         = 5'126;
+
+using manager_t = teddy::mss_manager<StateCount>;
+using diagram_t = manager_t::diagram_t;
+
+inline auto make_diagrams (manager_t& manager) -> std::vector<diagram_t>
+{
+    std::ranlux48 rng(Seed);
+    std::vector<diagram_t> diagrams;
+    for (int i = 0; i < DiagramCount; ++i)
+    {
+        auto const expr = teddy::tsl::make_minmax_expression(
+            rng,
+            VarCount,
+            TermCount,
+            TermSize
+        );
+        diagrams.push_back(teddy::tsl::make_diagram(expr, manager));
+    }
+    return diagrams;
+}
+} // namespace cpp_source
+
+#endif
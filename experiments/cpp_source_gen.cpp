@@ -0,0 +1,53 @@
+#include "cpp_source.hpp"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/**
+ *  \brief Writes standalone C++ source of the benchmark diagrams.
+ *
+ *  The generated file does not include anything, it is compiled into
+ *  a separate library without access to libteddy headers. Functions
+ *  are exported through arrays of pointers indexed by diagram id.
+ */
+auto main(int argc, char** argv) -> int
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: cpp-source-gen <output-file>\n";
+        return 1;
+    }
+
+    std::ofstream ofst(argv[1]);
+    if (not ofst.is_open())
+    {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+
+    cpp_source::manager_t manager(cpp_source::VarCount, 1'000'000);
+    auto const diagrams = cpp_source::make_diagrams(manager);
+    for (int i = 0; i < cpp_source::DiagramCount; ++i)
+    {
+        std::string const name = "diagram_" + std::to_string(i);
+        manager.to_cpp_source(ofst, diagrams[(size_t)i], name, true);
+        ofst << "\n";
+    }
+
+    ofst << "extern int (*const generated_functions[])(int const*) = {\n";
+    for (int i = 0; i < cpp_source::DiagramCount; ++i)
+    {
+        ofst << "    diagram_" << i << ",\n";
+    }
+    ofst << "};\n\n";
+
+    ofst << "extern double (*const generated_availabilities[])"
+         << "(double const* const*, int) = {\n";
+    for (int i = 0; i < cpp_source::DiagramCount; ++i)
+    {
+        ofst << "    diagram_" << i << "_availability,\n";
+    }
+    ofst << "};\n";
+
+    return ofst ? 0 : 1;
+}
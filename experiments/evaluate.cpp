@@ -0,0 +1,103 @@
+#include <libteddy/core.hpp>
+#include <libtsl/expressions.hpp>
+#include <libtsl/generators.hpp>
+#include <chrono>
+#include <nanobench/nanobench.h>
+#include <iostream>
+#include <random>
+#include <vector>
+
+char const* unit_str(std::chrono::nanoseconds) { return "ns"; }
+char const* unit_str(std::chrono::microseconds){ return "µs"; }
+char const* unit_str(std::chrono::milliseconds){ return "ms"; }
+
+auto main() -> int
+{
+    namespace ch = std::chrono;
+    using time_unit = ch::microseconds;
+
+    char const* const Sep         = "\t";
+    char const* const Eol         = "\n";
+    int constexpr DiagramCount    = 5;
+    int constexpr ReplCount       = 3;
+    int constexpr StateCount      = 3;
+    int constexpr AssignmentCount = 1'000'000;
+    int constexpr Seed            = 5'126;
+    int constexpr VarCount        = 20;
+    int constexpr TermCount       = 35;
+    int constexpr TermSize        = 7;
+
+    std::ranlux48 exprRng(Seed);
+    std::ranlux48 valueRng(Seed + 1);
+    std::uniform_int_distribution<int> valueDist(0, StateCount - 1);
+
+    std::vector<std::vector<int>> assignments(AssignmentCount);
+    for (std::vector<int>& values : assignments)
+    {
+        values.resize(VarCount);
+        for (int& value : values)
+        {
+            value = valueDist(valueRng);
+        }
+    }
+
+    std::cout << "diagram-id"     << Sep
+              << "node-count"     << Sep
+              << "evaluate["      << unit_str(time_unit()) << "]" << Sep
+              << "evaluate-many[" << unit_str(time_unit()) << "]" << Sep
+              << "relative"       << Eol;
+
+    for (int diagramId = 0; diagramId < DiagramCount; ++diagramId)
+    {
+        auto const expr = teddy::tsl::make_minmax_expression(
+            exprRng,
+            VarCount,
+            TermCount,
+            TermSize
+        );
+        teddy::mdd_manager<StateCount> manager(VarCount, 1'000'000);
+        auto const diagram = teddy::tsl::make_diagram(expr, manager);
+        auto const nodeCount = manager.get_node_count(diagram);
+        std::vector<int> results(AssignmentCount);
+
+        for (int repl = 0; repl < ReplCount; ++repl)
+        {
+            std::cout << diagramId << Sep
+                      << nodeCount << Sep;
+
+            time_unit timeLoop = time_unit::zero();
+            time_unit timeMany = time_unit::zero();
+
+            // evaluate in a loop
+            {
+                auto const start = ch::high_resolution_clock::now();
+                for (int i = 0; i < AssignmentCount; ++i)
+                {
+                    results[(size_t)i] = manager.evaluate(
+                        diagram,
+                        assignments[(size_t)i]
+                    );
+                }
+                ankerl::nanobench::doNotOptimizeAway(results);
+                auto const end = ch::high_resolution_clock::now();
+                timeLoop = ch::duration_cast<time_unit>(end - start);
+                std::cout << timeLoop.count() << Sep;
+            }
+
+            // evaluate_many
+            {
+                auto const start = ch::high_resolution_clock::now();
+                manager.evaluate_many(diagram, assignments, results.begin());
+                ankerl::nanobench::doNotOptimizeAway(results);
+                auto const end = ch::high_resolution_clock::now();
+                timeMany = ch::duration_cast<time_unit>(end - start);
+                std::cout << timeMany.count() << Sep;
+            }
+
+            double const relative =
+                static_cast<double>(timeMany.count()) /
+                static_cast<double>(timeLoop.count());
+            std::cout << relative << Eol;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#include <libteddy/core.hpp>
+#include <chrono>
+#include <nanobench/nanobench.h>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+char const* unit_str(std::chrono::nanoseconds) { return "ns"; }
+char const* unit_str(std::chrono::microseconds){ return "µs"; }
+char const* unit_str(std::chrono::milliseconds){ return "ms"; }
+
+/**
+ *  \brief Creates random products of literals.
+ */
+auto make_products (
+    teddy::bdd_manager& manager,
+    std::ranlux48& rng,
+    int termCount,
+    int literalCount
+) -> std::vector<teddy::bdd_manager::diagram_t>
+{
+    using diagram_t = teddy::bdd_manager::diagram_t;
+    std::uniform_int_distribution<int> varDist(0, manager.get_var_count() - 1);
+    std::uniform_int_distribution<int> valueDist(0, 1);
+    std::vector<diagram_t> products;
+    for (int ti = 0; ti < termCount; ++ti)
+    {
+        std::vector<diagram_t> literals;
+        for (int i = 0; i < literalCount; ++i)
+        {
+            int const index = varDist(rng);
+            literals.push_back(
+                valueDist(rng) == 1 ? manager.variable(index)
+                                    : manager.variable_not(index)
+            );
+        }
+        products.push_back(manager.left_fold<teddy::ops::AND>(literals));
+    }
+    return products;
+}
+
+auto main() -> int
+{
+    namespace ch = std::chrono;
+    using time_unit = ch::milliseconds;
+
+    char const* const Sep      = "\t";
+    char const* const Eol      = "\n";
+    int constexpr ReplCount    = 3;
+    int constexpr Seed         = 5'126;
+    int constexpr VarCount     = 24;
+    int constexpr TermCount    = 1'000;
+    int constexpr LiteralCount = 8;
+
+    std::ranlux48 rng(Seed);
+    int const hardwareThreads
+        = static_cast<int>(std::thread::hardware_concurrency());
+
+    std::cout << "hardware-threads=" << hardwareThreads << Eol;
+    std::cout << "threads"    << Sep
+              << "time["      << unit_str(time_unit()) << "]" << Sep
+              << "speedup"    << Sep
+              << "node-count" << Eol;
+
+    for (int repl = 0; repl < ReplCount; ++repl)
+    {
+        teddy::bdd_manager manager(VarCount, 1'000'000);
+        auto const products
+            = make_products(manager, rng, TermCount, LiteralCount);
+
+        double baseTime = 0;
+        for (int const threadCount : {1, 2, 4, 8})
+        {
+            auto copy        = products;
+            auto const start = ch::high_resolution_clock::now();
+            auto const sum
+                = threadCount == 1
+                    ? manager.tree_fold<teddy::ops::OR>(copy)
+                    : manager.tree_fold_parallel<teddy::ops::OR>(
+                          products,
+                          threadCount
+                      );
+            ankerl::nanobench::doNotOptimizeAway(sum);
+            auto const end  = ch::high_resolution_clock::now();
+            auto const time = ch::duration_cast<time_unit>(end - start);
+            if (threadCount == 1)
+            {
+                baseTime = static_cast<double>(time.count());
+            }
+
+            std::cout << threadCount << Sep
+                      << time.count() << Sep
+                      << baseTime / static_cast<double>(time.count()) << Sep
+                      << manager.get_node_count(sum) << Eol;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include <libteddy/core.hpp>
+#include <libtsl/expressions.hpp>
+#include <libtsl/generators.hpp>
+#include <chrono>
+#include <nanobench/nanobench.h>
+#include <iostream>
+#include <random>
+
+char const* unit_str(std::chrono::nanoseconds) { return "ns"; }
+char const* unit_str(std::chrono::microseconds){ return "µs"; }
+char const* unit_str(std::chrono::milliseconds){ return "ms"; }
+
+auto fold_name (teddy::fold_type const foldType) -> char const*
+{
+    switch (foldType)
+    {
+    case teddy::fold_type::Left:
+        return "left";
+    case teddy::fold_type::Tree:
+        return "tree";
+    case teddy::fold_type::SizeOrdered:
+        return "size-ordered";
+    }
+    return "";
+}
+
+/**
+ *  \brief Measures construction of diagrams of random minmax expressions
+ *  using different fold strategies. Each measurement uses a new manager.
+ */
+template<class MakeManager>
+auto run_fold_strategies (
+    char const* const managerName,
+    MakeManager makeManager,
+    std::ranlux48& rng,
+    int const exprCount,
+    int const termCount,
+    int const termSize
+) -> void
+{
+    namespace ch = std::chrono;
+    using time_unit = ch::milliseconds;
+
+    char const* const Sep = "\t";
+    char const* const Eol = "\n";
+    int const varCount    = makeManager().get_var_count();
+
+    for (int exprId = 0; exprId < exprCount; ++exprId)
+    {
+        auto const expr = teddy::tsl::make_minmax_expression(
+            rng,
+            varCount,
+            termCount,
+            termSize
+        );
+
+        for (auto const foldType :
+             {teddy::fold_type::Left,
+              teddy::fold_type::Tree,
+              teddy::fold_type::SizeOrdered})
+        {
+            auto manager     = makeManager();
+            auto const start = ch::high_resolution_clock::now();
+            auto const diagram
+                = teddy::tsl::make_diagram(expr, manager, foldType);
+            ankerl::nanobench::doNotOptimizeAway(diagram);
+            auto const end  = ch::high_resolution_clock::now();
+            auto const time = ch::duration_cast<time_unit>(end - start);
+
+            std::cout << managerName << Sep
+                      << exprId << Sep
+                      << fold_name(foldType) << Sep
+                      << time.count() << Sep
+                      << manager.get_node_count(diagram) << Eol;
+        }
+    }
+}
+
+auto main() -> int
+{
+    char const* const Sep     = "\t";
+    char const* const Eol     = "\n";
+    int constexpr Seed        = 5'126;
+    int constexpr ExprCount   = 5;
+    int constexpr BddVarCount = 40;
+    int constexpr MddVarCount = 16;
+    int constexpr TermCount   = 30;
+    int constexpr TermSize    = 5;
+
+    std::ranlux48 rng(Seed);
+
+    std::cout << "manager"    << Sep
+              << "expr-id"    << Sep
+              << "fold"       << Sep
+              << "time["      << unit_str(std::chrono::milliseconds()) << "]"
+                              << Sep
+              << "node-count" << Eol;
+
+    run_fold_strategies(
+        "bdd",
+        [] { return teddy::bdd_manager(BddVarCount, 1'000'000); },
+        rng,
+        ExprCount,
+        TermCount,
+        TermSize
+    );
+
+    run_fold_strategies(
+        "mdd",
+        [] { return teddy::mdd_manager<3>(MddVarCount, 1'000'000); },
+        rng,
+        ExprCount,
+        TermCount,
+        TermSize
+    );
+}
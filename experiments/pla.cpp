@@ -0,0 +1,179 @@
+#include <libteddy/core.hpp>
+#include <chrono>
+#include <nanobench/nanobench.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+char const* unit_str(std::chrono::nanoseconds) { return "ns"; }
+char const* unit_str(std::chrono::microseconds){ return "µs"; }
+char const* unit_str(std::chrono::milliseconds){ return "ms"; }
+
+/**
+ *  \brief Writes random PLA file with given parameters.
+ */
+auto write_pla (
+    std::string const& path,
+    std::ranlux48& rng,
+    int varCount,
+    int functionCount,
+    int lineCount,
+    int literalCount
+) -> void
+{
+    std::uniform_int_distribution<int> varDist(0, varCount - 1);
+    std::uniform_int_distribution<int> valueDist(0, 1);
+    std::ofstream ofst(path);
+    ofst << ".i " << varCount << "\n"
+         << ".o " << functionCount << "\n"
+         << ".p " << lineCount << "\n";
+    for (int li = 0; li < lineCount; ++li)
+    {
+        std::string cube(static_cast<std::size_t>(varCount), '-');
+        for (int i = 0; i < literalCount; ++i)
+        {
+            cube[static_cast<std::size_t>(varDist(rng))]
+                = valueDist(rng) == 1 ? '1' : '0';
+        }
+        std::string output;
+        for (int fi = 0; fi < functionCount; ++fi)
+        {
+            output.push_back(valueDist(rng) == 1 ? '1' : '0');
+        }
+        ofst << cube << " " << output << "\n";
+    }
+    ofst << ".e\n";
+}
+
+/**
+ *  \brief Previous construction, product of each line is folded
+ *  from diagrams of literals for each function.
+ */
+auto literal_fold_pla (
+    teddy::bdd_manager& manager,
+    teddy::pla_file const& file,
+    teddy::fold_type const foldType
+) -> std::vector<teddy::bdd_manager::diagram_t>
+{
+    using diagram_t = teddy::bdd_manager::diagram_t;
+    std::vector<diagram_t> functions;
+    for (int fi = 0; fi < file.get_function_count(); ++fi)
+    {
+        std::vector<diagram_t> products;
+        for (auto const& line : file.get_lines())
+        {
+            if (line.fVals_.get(fi) != 1)
+            {
+                continue;
+            }
+
+            std::vector<diagram_t> literals;
+            for (int i = 0; i < line.cube_.size(); ++i)
+            {
+                if (line.cube_.get(i) == 1)
+                {
+                    literals.push_back(manager.variable(i));
+                }
+                else if (line.cube_.get(i) == 0)
+                {
+                    literals.push_back(manager.variable_not(i));
+                }
+            }
+            products.push_back(
+                manager.left_fold<teddy::ops::AND>(literals)
+            );
+        }
+        functions.push_back(
+            foldType == teddy::fold_type::Left
+                ? manager.left_fold<teddy::ops::OR>(products)
+                : manager.tree_fold<teddy::ops::OR>(products)
+        );
+    }
+    return functions;
+}
+
+auto main() -> int
+{
+    namespace ch = std::chrono;
+    using time_unit = ch::milliseconds;
+
+    char const* const Sep       = "\t";
+    char const* const Eol       = "\n";
+    int constexpr FileCount     = 3;
+    int constexpr ReplCount     = 3;
+    int constexpr Seed          = 5'126;
+    int constexpr VarCount      = 24;
+    int constexpr FunctionCount = 4;
+    int constexpr LineCount     = 300;
+    int constexpr LiteralCount  = 8;
+
+    std::ranlux48 rng(Seed);
+    std::string const path
+        = (std::filesystem::temp_directory_path() / "teddy-pla-bench.pla")
+              .string();
+
+    std::cout << "file-id"    << Sep
+              << "fold"       << Sep
+              << "literals["  << unit_str(time_unit()) << "]" << Sep
+              << "cubes["     << unit_str(time_unit()) << "]" << Sep
+              << "relative"   << Eol;
+
+    for (int fileId = 0; fileId < FileCount; ++fileId)
+    {
+        write_pla(path, rng, VarCount, FunctionCount, LineCount, LiteralCount);
+        auto const file = teddy::pla_file::load_file(path);
+        if (not file)
+        {
+            std::cerr << "Failed to load " << path << Eol;
+            return 1;
+        }
+
+        for (auto const foldType :
+             {teddy::fold_type::Left, teddy::fold_type::Tree})
+        {
+            for (int repl = 0; repl < ReplCount; ++repl)
+            {
+                std::cout << fileId << Sep
+                          << (foldType == teddy::fold_type::Left
+                                  ? "left"
+                                  : "tree")
+                          << Sep;
+
+                time_unit timeLiterals = time_unit::zero();
+                time_unit timeCubes    = time_unit::zero();
+
+                // fold of literals
+                {
+                    teddy::bdd_manager manager(VarCount, 1'000'000);
+                    auto const start = ch::high_resolution_clock::now();
+                    auto diagrams = literal_fold_pla(manager, *file, foldType);
+                    ankerl::nanobench::doNotOptimizeAway(diagrams);
+                    auto const end = ch::high_resolution_clock::now();
+                    timeLiterals = ch::duration_cast<time_unit>(end - start);
+                    std::cout << timeLiterals.count() << Sep;
+                }
+
+                // direct cube chains
+                {
+                    teddy::bdd_manager manager(VarCount, 1'000'000);
+                    auto const start = ch::high_resolution_clock::now();
+                    auto diagrams = manager.from_pla(*file, foldType);
+                    ankerl::nanobench::doNotOptimizeAway(diagrams);
+                    auto const end = ch::high_resolution_clock::now();
+                    timeCubes = ch::duration_cast<time_unit>(end - start);
+                    std::cout << timeCubes.count() << Sep;
+                }
+
+                double const relative =
+                    static_cast<double>(timeCubes.count()) /
+                    static_cast<double>(timeLiterals.count());
+                std::cout << relative << Eol;
+            }
+        }
+    }
+
+    std::filesystem::remove(path);
+}
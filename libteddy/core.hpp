@@ -1,7 +1,9 @@
 #ifndef LIBTEDDY_CORE_HPP
 #define LIBTEDDY_CORE_HPP
 
+#include <libteddy/details/dddmp_file.hpp>
 #include <libteddy/details/diagram_manager.hpp>
+#include <libteddy/details/mapped_file.hpp>
 #include <libteddy/details/pla_file.hpp>
 
 namespace teddy
@@ -0,0 +1,198 @@
+#ifndef LIBTEDDY_DETAILS_BINARY_FORMAT_HPP
+#define LIBTEDDY_DETAILS_BINARY_FORMAT_HPP
+
+#include <libteddy/details/types.hpp>
+
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+
+namespace teddy::binary
+{
+/**
+ *  \brief Magic bytes at the beginning of saved diagrams.
+ */
+inline constexpr char Magic[4] {'T', 'D', 'D', 'Y'};
+
+/**
+ *  \brief Version of the format, incremented on incompatible changes.
+ */
+inline constexpr uint32 Version = 1;
+
+/**
+ *  \brief Returns smallest number of bytes that can hold values
+ *  from [0, \p count)
+ *  \param count Number of different values
+ *  \return 1, 2, 4, or 8
+ */
+inline auto get_width (int64 count) -> int32;
+
+/**
+ *  \brief Writes integers in little-endian byte order.
+ */
+class byte_writer
+{
+public:
+    explicit byte_writer(std::ostream& ost);
+
+    /**
+     *  \brief Writes lowest \p width bytes of \p value
+     */
+    auto write (uint64 value, int32 width) -> void;
+
+    /**
+     *  \brief Writes \p value using all its bytes
+     */
+    template<class Int>
+    auto write (Int value) -> void;
+
+    /**
+     *  \brief Returns true if all writes succeeded
+     */
+    [[nodiscard]] auto is_ok () const -> bool;
+
+private:
+    std::ostream* ost_;
+};
+
+/**
+ *  \brief Reads integers in little-endian byte order from a buffer.
+ *
+ *  Reading past the end of the buffer does not read anything and puts
+ *  the reader into the failed state.
+ */
+class byte_reader
+{
+public:
+    byte_reader(std::byte const* first, int64 size);
+
+    /**
+     *  \brief Reads \p width bytes as an unsigned integer
+     */
+    auto read (int32 width) -> uint64;
+
+    /**
+     *  \brief Reads value of type \p Int using all its bytes
+     */
+    template<class Int>
+    auto read () -> Int;
+
+    /**
+     *  \brief Returns number of bytes that were not read yet
+     */
+    [[nodiscard]] auto get_remaining () const -> int64;
+
+    /**
+     *  \brief Returns true if all reads succeeded
+     */
+    [[nodiscard]] auto is_ok () const -> bool;
+
+private:
+    std::byte const* current_;
+    std::byte const* last_;
+    bool isOk_;
+};
+
+inline auto get_width(int64 const count) -> int32
+{
+    if (count <= (int64(1) << 8))
+    {
+        return 1;
+    }
+
+    if (count <= (int64(1) << 16))
+    {
+        return 2;
+    }
+
+    if (count <= (int64(1) << 32))
+    {
+        return 4;
+    }
+
+    return 8;
+}
+
+// byte_writer definitions:
+
+inline byte_writer::byte_writer(std::ostream& ost) : ost_(&ost)
+{
+}
+
+inline auto byte_writer::write(uint64 value, int32 const width) -> void
+{
+    char bytes[8];
+    for (int32 i = 0; i < width; ++i)
+    {
+        bytes[i] = static_cast<char>(value & 0xFF);
+        value >>= 8;
+    }
+    ost_->write(bytes, width);
+}
+
+template<class Int>
+auto byte_writer::write(Int const value) -> void
+{
+    static_assert(std::is_integral_v<Int>);
+    this->write(
+        static_cast<uint64>(static_cast<std::make_unsigned_t<Int>>(value)),
+        static_cast<int32>(sizeof(Int))
+    );
+}
+
+inline auto byte_writer::is_ok() const -> bool
+{
+    return static_cast<bool>(*ost_);
+}
+
+// byte_reader definitions:
+
+inline byte_reader::byte_reader(
+    std::byte const* const first,
+    int64 const size
+) :
+    current_(first),
+    last_(first + size),
+    isOk_(true)
+{
+}
+
+inline auto byte_reader::read(int32 const width) -> uint64
+{
+    if (last_ - current_ < width)
+    {
+        isOk_    = false;
+        current_ = last_;
+        return 0;
+    }
+
+    uint64 value = 0;
+    for (int32 i = 0; i < width; ++i)
+    {
+        value |= static_cast<uint64>(current_[i]) << (8 * i);
+    }
+    current_ += width;
+    return value;
+}
+
+template<class Int>
+auto byte_reader::read() -> Int
+{
+    static_assert(std::is_integral_v<Int>);
+    return static_cast<Int>(static_cast<std::make_unsigned_t<Int>>(
+        this->read(static_cast<int32>(sizeof(Int)))
+    ));
+}
+
+inline auto byte_reader::get_remaining() const -> int64
+{
+    return last_ - current_;
+}
+
+inline auto byte_reader::is_ok() const -> bool
+{
+    return isOk_;
+}
+} // namespace teddy::binary
+
+#endif
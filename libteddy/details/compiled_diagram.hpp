@@ -0,0 +1,978 @@
+#ifndef LIBTEDDY_DETAILS_COMPILED_DIAGRAM_HPP
+#define LIBTEDDY_DETAILS_COMPILED_DIAGRAM_HPP
+
+#include <libteddy/details/mapped_file.hpp>
+#include <libteddy/details/probabilities.hpp>
+#include <libteddy/details/tools.hpp>
+#include <libteddy/details/types.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace teddy
+{
+namespace details
+{
+/**
+ *  \brief Evaluates flat array of records for many variable assignments
+ *
+ *  Records are [index, son0, son1, ...] where sons are offsets of other
+ *  records and terminal sons are complemented values. Assignments are
+ *  processed in blocks, all assignments of a block advance through
+ *  the array together so that the inner loop has no dependencies
+ *  between iterations.
+ */
+template<std::ranges::random_access_range Vs, std::output_iterator<int32> O>
+auto evaluate_flat_many (
+    std::span<int32 const> nodes,
+    int32 root,
+    std::span<int32 const> domains,
+    Vs const& assignments,
+    O out
+) -> void;
+} // namespace details
+
+/**
+ *  \class compiled_diagram
+ *  \brief Immutable flat snapshot of a diagram.
+ *
+ *  Internal nodes are stored in a single contiguous array ordered by levels.
+ *  Each node is a record [index, son0, son1, ...] where sons are offsets
+ *  of other records. Terminal sons are stored as bitwise complement
+ *  of their values so they are always negative. The snapshot holds no
+ *  reference counts and does not reference the manager that created it.
+ *  Since it is never modified, it can be safely shared between threads.
+ *
+ *  Records are preceded by a level index (offset of the first record
+ *  of each level) and a table of terminal values. Since offsets are
+ *  relative to the first record, the snapshot can be saved by \c save
+ *  and memory-mapped by \c map_file without any deserialization.
+ *  Processes that map the same file share its page-cached copy.
+ */
+class compiled_diagram
+{
+public:
+    /**
+     *  \brief Memory-maps snapshot saved by \c save
+     *
+     *  Records are used directly from the mapped memory without any
+     *  deserialization. They are only read once to check that all
+     *  of the offsets are valid. The file must be created by \c save
+     *  on a machine with the same byte order.
+     *
+     *  \param path Path to the file
+     *  \return Optional holding the snapshot or \c std::nullopt if the
+     *  file could not be mapped or is malformed
+     */
+    static auto map_file (std::string const& path)
+        -> std::optional<compiled_diagram>;
+
+public:
+    /**
+     *  \brief Initializes the snapshot. Use \c diagram_manager::compile
+     *  to create the snapshot from a diagram.
+     *  \param nodes Records of internal nodes ordered by levels
+     *  \param root Offset of the root record or complemented value
+     *  of the terminal if the diagram is constant
+     *  \param order Order of variables
+     *  \param domains Domains of variables
+     */
+    compiled_diagram(
+        std::vector<int32> nodes,
+        int32 root,
+        std::vector<int32> const& order,
+        std::vector<int32> domains
+    );
+
+    compiled_diagram(compiled_diagram const&) = delete;
+    compiled_diagram(compiled_diagram&&) noexcept = default;
+    ~compiled_diagram() = default;
+
+    auto operator= (compiled_diagram const&) -> compiled_diagram& = delete;
+    auto operator= (compiled_diagram&&) noexcept
+        -> compiled_diagram& = default;
+
+    /**
+     *  \brief Saves the snapshot into a file that can be mapped
+     *  by \c map_file
+     *
+     *  The file consists of a header (magic bytes, version, byte order
+     *  mark, sizes, offset of the root, order and domains of variables)
+     *  followed by the level index, the terminal table and the records.
+     *  All values are 32-bit integers in native byte order.
+     *
+     *  \param path Path to the file
+     *  \return True if the file was written successfully
+     */
+    auto save (std::string const& path) const -> bool;
+
+    /**
+     *  \brief Evaluates value of the function
+     *  \tparam Vars Container type that defines operator[] and returns
+     *  value convertible to int
+     *  \param values Container holding values of variables
+     *  \return Value of the function for variable values \p values
+     */
+    template<class Vars>
+    [[nodiscard]] auto evaluate (Vars const& values) const -> int32;
+
+    /**
+     *  \brief Evaluates value of the function for many variable assignments
+     *
+     *  Assignments are processed in blocks. All assignments of a block
+     *  advance through the node array together so that the inner loop
+     *  has no dependencies between iterations.
+     *
+     *  \tparam Vs Random access range of containers that hold
+     *  values of variables
+     *  \tparam O Output iterator type
+     *  \param assignments Range of variable assignments
+     *  \param out Output iterator that is used to output values of the
+     *  function in the same order as are the assignments
+     */
+    template<std::ranges::random_access_range Vs, std::output_iterator<int32> O>
+    auto evaluate_many (Vs const& assignments, O out) const -> void;
+
+    /**
+     *  \brief Calculates number of variable assignments for which
+     *  the functions evaluates to \p value
+     *  \param value Value of the function
+     *  \return Number of different variable assignments
+     */
+    [[nodiscard]] auto satisfy_count (int32 value) const -> int64;
+
+    /**
+     *  \brief Calculates probability that the function evaluates
+     *  to \p state
+     *
+     *  \p probs[i][k] must return probability that i-th variable
+     *  (component) has value k
+     *
+     *  \tparam Ps Type that holds component state probabilities
+     *  \param state Value of the function (system state)
+     *  \param probs Matrix of component state probabilities
+     *  \return Probability of the system state \p state
+     */
+    template<probs::prob_matrix Ps>
+    [[nodiscard]] auto calculate_probability (int32 state, Ps const& probs)
+        const -> double;
+
+    /**
+     *  \brief Calculates probability that the function evaluates to
+     *  value greater or equal to \p state
+     *  \tparam Ps Type that holds component state probabilities
+     *  \param state System state
+     *  \param probs Matrix of component state probabilities
+     *  \return System availability with respect to the state \p state
+     */
+    template<probs::prob_matrix Ps>
+    [[nodiscard]] auto calculate_availability (int32 state, Ps const& probs)
+        const -> double;
+
+    /**
+     *  \brief Calculates probability that the function evaluates to
+     *  value less than \p state
+     *  \tparam Ps Type that holds component state probabilities
+     *  \param state System state
+     *  \param probs Matrix of component state probabilities
+     *  \return System unavailability with respect to the state \p state
+     */
+    template<probs::prob_matrix Ps>
+    [[nodiscard]] auto calculate_unavailability (int32 state, Ps const& probs)
+        const -> double;
+
+    /**
+     *  \brief Prints standalone C++ source of the evaluation function
+     *
+     *  Prints definition of function
+     *  \c int \p name(int const* x) that evaluates the function for
+     *  variable values \c x . Each node is translated into a labeled
+     *  switch statement that jumps directly to the next node so the
+     *  generated code does not depend on the library.
+     *  If \p withAvailability is true, function
+     *  \c double \p name_availability(double const* const* p, int state)
+     *  is printed as well. \c p[i][k] is probability that i-th variable
+     *  has value k.
+     *
+     *  \param out Output stream (e.g. \c std::cout or \c std::ofstream )
+     *  \param name Name of the generated function
+     *  \param withAvailability Whether to print the availability function
+     */
+    auto to_cpp_source (
+        std::ostream& out,
+        std::string_view name,
+        bool withAvailability = false
+    ) const -> void;
+
+    /**
+     *  \brief Returns number of internal nodes
+     *  \return Number of nodes
+     */
+    [[nodiscard]] auto get_node_count () const -> int64;
+
+    /**
+     *  \brief Returns number of internal nodes with given index
+     *  \param index Index of the variable
+     *  \return Number of nodes
+     */
+    [[nodiscard]] auto get_node_count (int32 index) const -> int64;
+
+    /**
+     *  \brief Returns number of variables
+     *  \return Number of variables
+     */
+    [[nodiscard]] auto get_var_count () const -> int32;
+
+    /**
+     *  \brief Returns sorted values of terminal nodes
+     *  \return View of the terminal table
+     */
+    [[nodiscard]] auto get_terminal_values () const -> std::span<int32 const>;
+
+private:
+    static constexpr char Magic[4] {'T', 'D', 'D', 'C'};
+    static constexpr int32 Version       = 1;
+    static constexpr uint32 ByteOrderMark = 0x01020304;
+    static constexpr int32 HeaderSize    = 7;
+
+    compiled_diagram(
+        int32 root,
+        std::vector<int32> const& order,
+        std::vector<int32> domains
+    );
+
+    auto set_body (int32 const* body, int32 terminalCount, int32 nodesSize)
+        -> void;
+
+    [[nodiscard]] auto is_valid_body () const -> bool;
+
+    [[nodiscard]] auto get_level (int32 offset) const -> int32;
+
+    [[nodiscard]] auto domain_product (int32 levelFrom, int32 levelTo) const
+        -> int64;
+
+    template<class Ps, class TerminalOp>
+    auto calculate_terminal_probabilities (
+        Ps const& probs,
+        TerminalOp terminalOperation
+    ) const -> void;
+
+private:
+    // Body is [level index, terminal table, records].
+    std::vector<int32> ownedBody_;
+    std::optional<mapped_file> mappedFile_;
+    std::span<int32 const> levelOffsets_;
+    std::span<int32 const> terminals_;
+    std::span<int32 const> nodes_;
+    std::vector<int32> order_;
+    std::vector<int32> indexToLevel_;
+    std::vector<int32> domains_;
+    std::vector<int32> levelToDomain_;
+    int32 root_;
+    int32 varCount_;
+    int64 nodeCount_;
+};
+
+inline auto compiled_diagram::map_file(std::string const& path)
+    -> std::optional<compiled_diagram>
+{
+    std::optional<mapped_file> file = mapped_file::load_file(path);
+    if (not file || file->size() < HeaderSize * 4
+        || 0 != std::memcmp(file->data(), Magic, sizeof(Magic)))
+    {
+        return std::nullopt;
+    }
+
+    std::span<int32 const> const words = file->as_span<int32>();
+    int32 const varCount      = words[4];
+    int32 const terminalCount = words[5];
+    int32 const nodesSize     = words[6];
+    if (words[1] != Version || static_cast<uint32>(words[2]) != ByteOrderMark
+        || varCount < 0 || terminalCount < 0 || nodesSize < 0
+        || ssize(words)
+               != HeaderSize + int64(3) * varCount + 1 + terminalCount
+                      + nodesSize)
+    {
+        return std::nullopt;
+    }
+
+    int32 const root   = words[3];
+    auto const order   = std::vector<int32>(
+        words.begin() + HeaderSize,
+        words.begin() + HeaderSize + varCount
+    );
+    auto const domains = std::vector<int32>(
+        words.begin() + HeaderSize + varCount,
+        words.begin() + HeaderSize + 2 * varCount
+    );
+
+    // Order must be a permutation of indices.
+    std::vector<bool> isOrdered(as_usize(varCount), false);
+    for (int32 const index : order)
+    {
+        if (index < 0 || index >= varCount || isOrdered[as_uindex(index)])
+        {
+            return std::nullopt;
+        }
+        isOrdered[as_uindex(index)] = true;
+    }
+
+    for (int32 const domain : domains)
+    {
+        if (domain <= 0)
+        {
+            return std::nullopt;
+        }
+    }
+
+    compiled_diagram diagram(root, order, domains);
+    diagram.set_body(
+        words.data() + HeaderSize + 2 * varCount,
+        terminalCount,
+        nodesSize
+    );
+    if (not diagram.is_valid_body())
+    {
+        return std::nullopt;
+    }
+    diagram.mappedFile_.emplace(static_cast<mapped_file&&>(*file));
+    return std::optional<compiled_diagram>(
+        static_cast<compiled_diagram&&>(diagram)
+    );
+}
+
+inline compiled_diagram::compiled_diagram(
+    std::vector<int32> nodes,
+    int32 const root,
+    std::vector<int32> const& order,
+    std::vector<int32> domains
+) :
+    compiled_diagram(root, order, static_cast<std::vector<int32>&&>(domains))
+{
+    // Level index, records are ordered by levels.
+    std::vector<int32> levelOffsets;
+    levelOffsets.reserve(as_usize(varCount_ + 1));
+    std::vector<int32> terminals;
+    if (root_ < 0)
+    {
+        terminals.push_back(~root_);
+    }
+
+    int32 offset = 0;
+    while (offset < ssize(nodes))
+    {
+        int32 const index  = nodes[as_uindex(offset)];
+        int32 const level  = indexToLevel_[as_uindex(index)];
+        int32 const domain = domains_[as_uindex(index)];
+        while (ssize(levelOffsets) <= level)
+        {
+            levelOffsets.push_back(offset);
+        }
+        for (int32 k = 0; k < domain; ++k)
+        {
+            int32 const son = nodes[as_uindex(offset + 1 + k)];
+            if (son < 0)
+            {
+                terminals.push_back(~son);
+            }
+        }
+        offset += 1 + domain;
+    }
+    while (ssize(levelOffsets) <= varCount_)
+    {
+        levelOffsets.push_back(offset);
+    }
+
+    // Terminal table holds each value once.
+    utils::sort(terminals, [] (int32 const l, int32 const r) { return l < r; });
+    int64 terminalCount = 0;
+    for (int32 const value : terminals)
+    {
+        if (0 == terminalCount
+            || terminals[as_uindex(terminalCount - 1)] != value)
+        {
+            terminals[as_uindex(terminalCount)] = value;
+            ++terminalCount;
+        }
+    }
+    terminals.resize(as_usize(terminalCount));
+
+    ownedBody_.reserve(
+        levelOffsets.size() + terminals.size() + nodes.size()
+    );
+    ownedBody_.insert(
+        ownedBody_.end(),
+        levelOffsets.begin(),
+        levelOffsets.end()
+    );
+    ownedBody_.insert(ownedBody_.end(), terminals.begin(), terminals.end());
+    ownedBody_.insert(ownedBody_.end(), nodes.begin(), nodes.end());
+    this->set_body(
+        ownedBody_.data(),
+        static_cast<int32>(terminals.size()),
+        static_cast<int32>(nodes.size())
+    );
+}
+
+inline compiled_diagram::compiled_diagram(
+    int32 const root,
+    std::vector<int32> const& order,
+    std::vector<int32> domains
+) :
+    order_(order),
+    indexToLevel_(order.size()),
+    domains_(static_cast<std::vector<int32>&&>(domains)),
+    levelToDomain_(order.size()),
+    root_(root),
+    varCount_(static_cast<int32>(order.size())),
+    nodeCount_(0)
+{
+    assert(domains_.size() == order.size());
+
+    int32 level = 0;
+    for (int32 const index : order)
+    {
+        indexToLevel_[as_uindex(index)]  = level;
+        levelToDomain_[as_uindex(level)] = domains_[as_uindex(index)];
+        ++level;
+    }
+}
+
+inline auto compiled_diagram::set_body(
+    int32 const* const body,
+    int32 const terminalCount,
+    int32 const nodesSize
+) -> void
+{
+    levelOffsets_ = std::span<int32 const>(body, as_usize(varCount_ + 1));
+    terminals_    = std::span<int32 const>(
+        body + varCount_ + 1,
+        as_usize(terminalCount)
+    );
+    nodes_ = std::span<int32 const>(
+        body + varCount_ + 1 + terminalCount,
+        as_usize(nodesSize)
+    );
+
+    nodeCount_ = 0;
+    for (int32 index = 0; index < varCount_; ++index)
+    {
+        nodeCount_ += this->get_node_count(index);
+    }
+}
+
+inline auto compiled_diagram::save(std::string const& path) const -> bool
+{
+    auto ofst = std::ofstream(path, std::ios::binary);
+    if (not ofst.is_open())
+    {
+        return false;
+    }
+
+    auto const write_words = [&ofst] (std::span<int32 const> const words)
+    {
+        ofst.write(
+            reinterpret_cast<char const*>(words.data()),
+            static_cast<std::streamsize>(words.size_bytes())
+        );
+    };
+
+    int32 header[HeaderSize] {};
+    std::memcpy(header, Magic, sizeof(Magic));
+    header[1] = Version;
+    header[2] = static_cast<int32>(ByteOrderMark);
+    header[3] = root_;
+    header[4] = varCount_;
+    header[5] = static_cast<int32>(terminals_.size());
+    header[6] = static_cast<int32>(nodes_.size());
+    write_words(header);
+    write_words(order_);
+    write_words(domains_);
+    write_words(levelOffsets_);
+    write_words(terminals_);
+    write_words(nodes_);
+
+    return static_cast<bool>(ofst);
+}
+
+template<class Vars>
+auto compiled_diagram::evaluate(Vars const& values) const -> int32
+{
+    int32 offset = root_;
+    while (offset >= 0)
+    {
+        int32 const index = nodes_[as_uindex(offset)];
+        auto const value  = static_cast<int32>(values[as_uindex(index)]);
+        assert(value < domains_[as_uindex(index)]);
+        offset = nodes_[as_uindex(offset + 1 + value)];
+    }
+    return ~offset;
+}
+
+template<std::ranges::random_access_range Vs, std::output_iterator<int32> O>
+auto compiled_diagram::evaluate_many(Vs const& assignments, O out) const
+    -> void
+{
+    details::evaluate_flat_many(nodes_, root_, domains_, assignments, out);
+}
+
+inline auto compiled_diagram::satisfy_count(int32 const value) const -> int64
+{
+    if (root_ < 0)
+    {
+        return ~root_ == value ? this->domain_product(0, varCount_) : 0;
+    }
+
+    // Number of assignments that lead from the root to each node.
+    std::vector<int64> counts(nodes_.size(), 0);
+    counts[as_uindex(root_)] = this->domain_product(0, this->get_level(root_));
+    int64 result             = 0;
+
+    int32 offset = 0;
+    while (offset < ssize(nodes_))
+    {
+        int32 const index  = nodes_[as_uindex(offset)];
+        int32 const level  = indexToLevel_[as_uindex(index)];
+        int32 const domain = domains_[as_uindex(index)];
+        int64 const count  = counts[as_uindex(offset)];
+        for (int32 k = 0; k < domain; ++k)
+        {
+            int32 const son = nodes_[as_uindex(offset + 1 + k)];
+            if (son < 0)
+            {
+                if (~son == value)
+                {
+                    result
+                        += count * this->domain_product(level + 1, varCount_);
+                }
+            }
+            else
+            {
+                int32 const sonLevel = this->get_level(son);
+                counts[as_uindex(son)]
+                    += count * this->domain_product(level + 1, sonLevel);
+            }
+        }
+        offset += 1 + domain;
+    }
+
+    return result;
+}
+
+template<probs::prob_matrix Ps>
+auto compiled_diagram::calculate_probability(
+    int32 const state,
+    Ps const& probs
+) const -> double
+{
+    double result = 0;
+    this->calculate_terminal_probabilities(
+        probs,
+        [state, &result] (int32 const value, double const probability)
+        {
+            if (value == state)
+            {
+                result += probability;
+            }
+        }
+    );
+    return result;
+}
+
+template<probs::prob_matrix Ps>
+auto compiled_diagram::calculate_availability(
+    int32 const state,
+    Ps const& probs
+) const -> double
+{
+    double result = 0;
+    this->calculate_terminal_probabilities(
+        probs,
+        [state, &result] (int32 const value, double const probability)
+        {
+            if (value >= state && value != Undefined)
+            {
+                result += probability;
+            }
+        }
+    );
+    return result;
+}
+
+template<probs::prob_matrix Ps>
+auto compiled_diagram::calculate_unavailability(
+    int32 const state,
+    Ps const& probs
+) const -> double
+{
+    double result = 0;
+    this->calculate_terminal_probabilities(
+        probs,
+        [state, &result] (int32 const value, double const probability)
+        {
+            if (value < state)
+            {
+                result += probability;
+            }
+        }
+    );
+    return result;
+}
+
+inline auto compiled_diagram::to_cpp_source(
+    std::ostream& out,
+    std::string_view const name,
+    bool const withAvailability
+) const -> void
+{
+    out << "// Generated by TeDDy from a diagram with " << nodeCount_
+        << " internal nodes.\n\n";
+
+    // Evaluation: one labeled switch per node, records are level ordered
+    // so jumps always go forward.
+    out << "inline int " << name << "(int const* x)\n{\n";
+    if (root_ < 0)
+    {
+        out << "    return " << ~root_ << ";\n";
+    }
+    else
+    {
+        int32 offset = 0;
+        while (offset < ssize(nodes_))
+        {
+            int32 const index  = nodes_[as_uindex(offset)];
+            int32 const domain = domains_[as_uindex(index)];
+            if (offset != root_)
+            {
+                out << "n" << offset << ":\n";
+            }
+            out << "    switch (x[" << index << "])\n    {\n";
+            for (int32 k = 0; k < domain; ++k)
+            {
+                int32 const son = nodes_[as_uindex(offset + 1 + k)];
+                out << (k + 1 == domain ? "    default: " : "    case ");
+                if (k + 1 != domain)
+                {
+                    out << k << ": ";
+                }
+                if (son < 0)
+                {
+                    out << "return " << ~son << ";\n";
+                }
+                else
+                {
+                    out << "goto n" << son << ";\n";
+                }
+            }
+            out << "    }\n";
+            offset += 1 + domain;
+        }
+    }
+    out << "}\n";
+
+    if (not withAvailability)
+    {
+        return;
+    }
+
+    // Availability: nodes are evaluated bottom-up, i.e. in reverse order
+    // of records.
+    auto const output_son = [&out] (int32 const son)
+    {
+        if (son >= 0)
+        {
+            out << "n" << son;
+        }
+        else if (~son == Undefined)
+        {
+            out << "0.0";
+        }
+        else
+        {
+            out << "(state <= " << ~son << " ? 1.0 : 0.0)";
+        }
+    };
+
+    std::vector<int32> offsets;
+    offsets.reserve(as_usize(nodeCount_));
+    int32 offset = 0;
+    while (offset < ssize(nodes_))
+    {
+        offsets.push_back(offset);
+        offset += 1 + domains_[as_uindex(nodes_[as_uindex(offset)])];
+    }
+
+    out << "\ninline double " << name
+        << "_availability(double const* const* p, int state)\n{\n";
+    for (auto it = offsets.rbegin(); it != offsets.rend(); ++it)
+    {
+        int32 const index  = nodes_[as_uindex(*it)];
+        int32 const domain = domains_[as_uindex(index)];
+        out << "    double const n" << *it << " =";
+        for (int32 k = 0; k < domain; ++k)
+        {
+            out << (k == 0 ? " " : "\n        + ");
+            out << "p[" << index << "][" << k << "] * ";
+            output_son(nodes_[as_uindex(*it + 1 + k)]);
+        }
+        out << ";\n";
+    }
+    out << "    return ";
+    output_son(root_);
+    out << ";\n}\n";
+}
+
+inline auto compiled_diagram::get_node_count() const -> int64
+{
+    return nodeCount_;
+}
+
+inline auto compiled_diagram::get_node_count(int32 const index) const
+    -> int64
+{
+    // All records of a level have the same size.
+    int32 const level = indexToLevel_[as_uindex(index)];
+    int32 const size  = levelOffsets_[as_uindex(level + 1)]
+                     - levelOffsets_[as_uindex(level)];
+    return size / (1 + domains_[as_uindex(index)]);
+}
+
+inline auto compiled_diagram::get_var_count() const -> int32
+{
+    return varCount_;
+}
+
+inline auto compiled_diagram::get_terminal_values() const
+    -> std::span<int32 const>
+{
+    return terminals_;
+}
+
+template<class Ps, class TerminalOp>
+auto compiled_diagram::calculate_terminal_probabilities(
+    Ps const& probs,
+    TerminalOp terminalOperation
+) const -> void
+{
+    if (root_ < 0)
+    {
+        terminalOperation(~root_, 1.0);
+        return;
+    }
+
+    // Probability of reaching each node from the root.
+    std::vector<double> reach(nodes_.size(), 0.0);
+    reach[as_uindex(root_)] = 1.0;
+
+    int32 offset = 0;
+    while (offset < ssize(nodes_))
+    {
+        int32 const index  = nodes_[as_uindex(offset)];
+        int32 const domain = domains_[as_uindex(index)];
+        double const nodeReach = reach[as_uindex(offset)];
+        for (int32 k = 0; k < domain; ++k)
+        {
+            int32 const son = nodes_[as_uindex(offset + 1 + k)];
+            auto const sonReach
+                = nodeReach * static_cast<double>(
+                                  probs[as_uindex(index)][as_uindex(k)]
+                              );
+            if (son < 0)
+            {
+                terminalOperation(~son, sonReach);
+            }
+            else
+            {
+                reach[as_uindex(son)] += sonReach;
+            }
+        }
+        offset += 1 + domain;
+    }
+}
+
+inline auto compiled_diagram::is_valid_body() const -> bool
+{
+    // Terminal table is sorted and holds each value once.
+    for (int64 i = 0; i < ssize(terminals_); ++i)
+    {
+        int32 const value = terminals_[as_uindex(i)];
+        if (value < 0 || (i > 0 && terminals_[as_uindex(i - 1)] >= value))
+        {
+            return false;
+        }
+    }
+
+    auto const is_terminal = [this] (int32 const son)
+    {
+        int64 first = 0;
+        int64 last  = ssize(terminals_);
+        while (first < last)
+        {
+            int64 const middle = first + (last - first) / 2;
+            if (terminals_[as_uindex(middle)] < ~son)
+            {
+                first = middle + 1;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+        return first < ssize(terminals_)
+            && terminals_[as_uindex(first)] == ~son;
+    };
+
+    // Each level holds whole records.
+    if (levelOffsets_[0] != 0
+        || levelOffsets_[as_uindex(varCount_)] != ssize(nodes_))
+    {
+        return false;
+    }
+
+    for (int32 level = 0; level < varCount_; ++level)
+    {
+        int32 const size = levelOffsets_[as_uindex(level + 1)]
+                         - levelOffsets_[as_uindex(level)];
+        if (size < 0 || size % (1 + levelToDomain_[as_uindex(level)]) != 0)
+        {
+            return false;
+        }
+    }
+
+    // Offset of an internal son must be a start of a record
+    // below the given level.
+    auto const is_record = [this] (int32 const offset, int32 const minLevel)
+    {
+        if (offset >= ssize(nodes_))
+        {
+            return false;
+        }
+
+        int32 first = 0;
+        int32 last  = varCount_;
+        while (last - first > 1)
+        {
+            int32 const middle = first + (last - first) / 2;
+            if (levelOffsets_[as_uindex(middle)] <= offset)
+            {
+                first = middle;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+        int32 const recordSize = 1 + levelToDomain_[as_uindex(first)];
+        return first >= minLevel
+            && (offset - levelOffsets_[as_uindex(first)]) % recordSize == 0;
+    };
+
+    for (int32 level = 0; level < varCount_; ++level)
+    {
+        int32 const index  = order_[as_uindex(level)];
+        int32 const domain = levelToDomain_[as_uindex(level)];
+        int32 offset       = levelOffsets_[as_uindex(level)];
+        while (offset < levelOffsets_[as_uindex(level + 1)])
+        {
+            if (nodes_[as_uindex(offset)] != index)
+            {
+                return false;
+            }
+            for (int32 k = 0; k < domain; ++k)
+            {
+                int32 const son = nodes_[as_uindex(offset + 1 + k)];
+                if (son < 0 ? not is_terminal(son)
+                            : not is_record(son, level + 1))
+                {
+                    return false;
+                }
+            }
+            offset += 1 + domain;
+        }
+    }
+
+    return root_ < 0 ? is_terminal(root_) : is_record(root_, 0);
+}
+
+inline auto compiled_diagram::get_level(int32 const offset) const -> int32
+{
+    return offset < 0 ? varCount_
+                      : indexToLevel_[as_uindex(nodes_[as_uindex(offset)])];
+}
+
+inline auto compiled_diagram::domain_product(
+    int32 const levelFrom,
+    int32 const levelTo
+) const -> int64
+{
+    int64 product = 1;
+    for (int32 level = levelFrom; level < levelTo; ++level)
+    {
+        product *= levelToDomain_[as_uindex(level)];
+    }
+    return product;
+}
+
+template<std::ranges::random_access_range Vs, std::output_iterator<int32> O>
+auto details::evaluate_flat_many(
+    std::span<int32 const> const nodes,
+    int32 const root,
+    [[maybe_unused]] std::span<int32 const> const domains,
+    Vs const& assignments,
+    O out
+) -> void
+{
+    // Offsets of the assignments of the current block.
+    // Negative offset is a terminal with value ~offset.
+    int64 constexpr BlockSize = 64;
+    int32 offsets[BlockSize];
+
+    auto const count = static_cast<int64>(std::ranges::size(assignments));
+    auto const first = std::ranges::begin(assignments);
+    for (int64 blockFirst = 0; blockFirst < count; blockFirst += BlockSize)
+    {
+        int64 const blockSize = utils::min(BlockSize, count - blockFirst);
+        for (int64 j = 0; j < blockSize; ++j)
+        {
+            offsets[j] = root;
+        }
+
+        bool isDone = false;
+        while (not isDone)
+        {
+            isDone = true;
+            for (int64 j = 0; j < blockSize; ++j)
+            {
+                int32 const offset = offsets[j];
+                if (offset >= 0)
+                {
+                    auto const& values = *(first + (blockFirst + j));
+                    int32 const index  = nodes[as_uindex(offset)];
+                    auto const value
+                        = static_cast<int32>(values[as_uindex(index)]);
+                    assert(value < domains[as_uindex(index)]);
+                    int32 const next = nodes[as_uindex(offset + 1 + value)];
+                    offsets[j]       = next;
+                    isDone           = isDone && next < 0;
+                }
+            }
+        }
+
+        for (int64 j = 0; j < blockSize; ++j)
+        {
+            *out++ = ~offsets[j];
+        }
+    }
+}
+} // namespace teddy
+
+#endif
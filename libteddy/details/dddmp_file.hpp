@@ -0,0 +1,651 @@
+#ifndef LIBTEDDY_DETAILS_DDDMP_FILE_HPP
+#define LIBTEDDY_DETAILS_DDDMP_FILE_HPP
+
+#include <libteddy/details/tools.hpp>
+#include <libteddy/details/types.hpp>
+
+#include <cassert>
+#include <fstream>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace teddy
+{
+/**
+ *  \brief Encoding of the node table in a DDDMP file
+ */
+enum class dddmp_mode
+{
+    Text,
+    Binary
+};
+
+/**
+ *  \brief Representation of a BDD stored in the DDDMP format
+ *
+ *  DDDMP is the format used by CUDD (\c Dddmp_cuddBddStore ). Nodes
+ *  are numbered from 1 in the order they appear in the file and sons
+ *  always precede their parents. Edges may be complemented, which is
+ *  denoted by a negative node id. Both the text mode (\c .mode \c A )
+ *  and the binary mode (\c .mode \c B ) are supported.
+ */
+class dddmp_file
+{
+public:
+    /**
+     *  \brief One line of the node table.
+     *
+     *  If both \c then_ and \c else_ are 0, the node is a leaf and
+     *  \c var_ holds its value. Otherwise, \c var_ is the id
+     *  of the variable.
+     */
+    struct dddmp_node
+    {
+        int32 var_;
+        int32 then_;
+        int32 else_;
+    };
+
+public:
+    /**
+     *  \brief Loads DDDMP file from a stream
+     *  \param ist Input stream
+     *  \return Optional holding instance of \c dddmp_file or
+     *  \c std::nullopt if the input is malformed or stores an ADD
+     */
+    static auto load (std::istream& ist) -> std::optional<dddmp_file>;
+
+    /**
+     *  \brief Loads DDDMP file from a file at given path
+     *  \param path Path to the file
+     *  \return Optional holding instance of \c dddmp_file or
+     *  \c std::nullopt if the loading failed
+     */
+    static auto load_file (std::string const& path)
+        -> std::optional<dddmp_file>;
+
+public:
+    /**
+     *  \brief Returns number of variables declared in the file
+     *  \return Number of variables (\c .nvars )
+     */
+    [[nodiscard]] auto get_var_count () const -> int32;
+
+    /**
+     *  \brief Returns node table, node with id \c i is at index \c i-1
+     *  \return Reference to a vector of nodes
+     */
+    [[nodiscard]] auto get_nodes () const -> std::vector<dddmp_node> const&;
+
+    /**
+     *  \brief Returns ids of root nodes, negative id is a complemented root
+     *  \return Reference to a vector of ids
+     */
+    [[nodiscard]] auto get_root_ids () const -> std::vector<int32> const&;
+
+    /**
+     *  \brief Writes node table in the binary mode
+     *
+     *  The first node must be the leaf. Variables of nodes are given
+     *  as positions in the \c .ids list, the leaf has position
+     *  \p suppCount . Variable ids of nodes are ignored.
+     *
+     *  \param out Output stream opened in binary mode
+     *  \param nodes Node table, node with id \c i is at index \c i-1
+     *  \param positions \c positions[i] is the position of the variable
+     *  of the node at index \c i
+     *  \param suppCount Number of variables in the \c .ids list
+     */
+    static auto write_binary_nodes (
+        std::ostream& out,
+        std::vector<dddmp_node> const& nodes,
+        std::vector<int32> const& positions,
+        int32 suppCount
+    ) -> void;
+
+private:
+    dddmp_file(
+        int32 varCount,
+        std::vector<dddmp_node> nodes,
+        std::vector<int32> rootIds
+    );
+
+    static auto parse_ints (std::istringstream& ist)
+        -> std::optional<std::vector<int32>>;
+
+    static auto read_text_nodes (
+        std::istream& ist,
+        std::vector<int32> const& suppIds,
+        int64 nodeCount
+    ) -> std::optional<std::vector<dddmp_node>>;
+
+    static auto read_binary_nodes (
+        std::istream& ist,
+        std::vector<int32> const& suppIds,
+        int32 suppCount,
+        int64 nodeCount
+    ) -> std::optional<std::vector<dddmp_node>>;
+
+    static auto is_valid_son (int32 sonId, int32 id) -> bool;
+
+    static auto read_byte (std::istream& ist) -> std::optional<int32>;
+
+    static auto read_int (std::istream& ist) -> std::optional<int32>;
+
+    static auto write_byte (std::ostream& out, int32 byte) -> void;
+
+    static auto write_int (std::ostream& out, int32 value) -> void;
+
+private:
+    /**
+     *  \brief Codes of variables and sons in the binary mode
+     */
+    static constexpr int32 Terminal   = 0;
+    static constexpr int32 AbsoluteId = 1;
+    static constexpr int32 RelativeId = 2;
+    static constexpr int32 Relative1  = 3;
+
+private:
+    int32 varCount_;
+    std::vector<dddmp_node> nodes_;
+    std::vector<int32> rootIds_;
+};
+
+inline auto dddmp_file::load(std::istream& ist) -> std::optional<dddmp_file>
+{
+    int32 varCount  = 0;
+    int64 nodeCount = -1;
+    bool isBinary   = false;
+    std::vector<int32> suppIds;
+    std::vector<int32> rootIds;
+
+    // Header.
+    std::string line;
+    bool isHeader = true;
+    while (isHeader && std::getline(ist, line))
+    {
+        std::istringstream lineIst(line);
+        std::string key;
+        lineIst >> key;
+        if (key == ".mode")
+        {
+            std::string mode;
+            lineIst >> mode;
+            if (mode != "A" && mode != "B")
+            {
+                return std::nullopt;
+            }
+            isBinary = mode == "B";
+        }
+        else if (key == ".add")
+        {
+            return std::nullopt;
+        }
+        else if (key == ".nvars")
+        {
+            lineIst >> varCount;
+        }
+        else if (key == ".nnodes")
+        {
+            lineIst >> nodeCount;
+        }
+        else if (key == ".ids")
+        {
+            std::optional<std::vector<int32>> ids = parse_ints(lineIst);
+            if (not ids)
+            {
+                return std::nullopt;
+            }
+            suppIds = static_cast<std::vector<int32>&&>(*ids);
+        }
+        else if (key == ".rootids")
+        {
+            std::optional<std::vector<int32>> ids = parse_ints(lineIst);
+            if (not ids)
+            {
+                return std::nullopt;
+            }
+            rootIds = static_cast<std::vector<int32>&&>(*ids);
+        }
+        else if (key == ".nodes")
+        {
+            isHeader = false;
+        }
+
+        if (lineIst.bad())
+        {
+            return std::nullopt;
+        }
+    }
+
+    if (isHeader || nodeCount < 0)
+    {
+        return std::nullopt;
+    }
+
+    // Without the .ids list, positions are the variable ids.
+    int32 const suppCount
+        = suppIds.empty() ? varCount : static_cast<int32>(ssize(suppIds));
+    std::optional<std::vector<dddmp_node>> nodes
+        = isBinary ? read_binary_nodes(ist, suppIds, suppCount, nodeCount)
+                   : read_text_nodes(ist, suppIds, nodeCount);
+    if (not nodes)
+    {
+        return std::nullopt;
+    }
+
+    for (int32 const rootId : rootIds)
+    {
+        if (rootId == 0 || rootId > nodeCount || rootId < -nodeCount)
+        {
+            return std::nullopt;
+        }
+    }
+
+    return dddmp_file(
+        varCount,
+        static_cast<std::vector<dddmp_node>&&>(*nodes),
+        static_cast<std::vector<int32>&&>(rootIds)
+    );
+}
+
+inline auto dddmp_file::load_file(std::string const& path)
+    -> std::optional<dddmp_file>
+{
+    // Binary mode keeps node records of .mode B files intact.
+    auto ifst = std::ifstream(path, std::ios::binary);
+    if (not ifst.is_open())
+    {
+        return std::nullopt;
+    }
+    return load(ifst);
+}
+
+inline auto dddmp_file::get_var_count() const -> int32
+{
+    return varCount_;
+}
+
+inline auto dddmp_file::get_nodes() const -> std::vector<dddmp_node> const&
+{
+    return nodes_;
+}
+
+inline auto dddmp_file::get_root_ids() const -> std::vector<int32> const&
+{
+    return rootIds_;
+}
+
+inline dddmp_file::dddmp_file(
+    int32 const varCount,
+    std::vector<dddmp_node> nodes,
+    std::vector<int32> rootIds
+) :
+    varCount_(varCount),
+    nodes_(static_cast<std::vector<dddmp_node>&&>(nodes)),
+    rootIds_(static_cast<std::vector<int32>&&>(rootIds))
+{
+}
+
+inline auto dddmp_file::parse_ints(std::istringstream& ist)
+    -> std::optional<std::vector<int32>>
+{
+    std::vector<int32> ints;
+    std::string word;
+    while (ist >> word)
+    {
+        std::optional<int32> const value = utils::parse<int32>(word);
+        if (not value)
+        {
+            return std::nullopt;
+        }
+        ints.push_back(*value);
+    }
+    return ints;
+}
+inline auto dddmp_file::read_text_nodes(
+    std::istream& ist,
+    std::vector<int32> const& suppIds,
+    int64 const nodeCount
+) -> std::optional<std::vector<dddmp_node>>
+{
+    // Node table, each line is: id [var-extra-info] var then else
+    // where var is the position of the variable in the .ids list.
+    std::vector<dddmp_node> nodes;
+    nodes.reserve(as_usize(nodeCount));
+    std::string line;
+    bool isEnd = false;
+    while (not isEnd && std::getline(ist, line))
+    {
+        if (line.starts_with(".end"))
+        {
+            isEnd = true;
+            continue;
+        }
+
+        std::istringstream lineIst(line);
+        std::vector<std::string> words;
+        std::string word;
+        while (lineIst >> word)
+        {
+            words.push_back(word);
+        }
+        if (words.empty())
+        {
+            continue;
+        }
+        if (ssize(words) != 4 && ssize(words) != 5)
+        {
+            return std::nullopt;
+        }
+
+        int64 const first = ssize(words) - 3;
+        std::optional<int32> const id = utils::parse<int32>(words[0]);
+        std::optional<int32> const var
+            = utils::parse<int32>(words[as_uindex(first)]);
+        std::optional<int32> const thenId
+            = utils::parse<int32>(words[as_uindex(first + 1)]);
+        std::optional<int32> const elseId
+            = utils::parse<int32>(words[as_uindex(first + 2)]);
+        if (not id || not var || not thenId || not elseId
+            || *id != ssize(nodes) + 1)
+        {
+            return std::nullopt;
+        }
+
+        if (*thenId == 0 && *elseId == 0)
+        {
+            nodes.push_back(dddmp_node {*var, 0, 0});
+            continue;
+        }
+
+        if (not is_valid_son(*thenId, *id) || not is_valid_son(*elseId, *id)
+            || *var < 0 || (not suppIds.empty() && *var >= ssize(suppIds)))
+        {
+            return std::nullopt;
+        }
+
+        int32 const varId = suppIds.empty() ? *var : suppIds[as_uindex(*var)];
+        nodes.push_back(dddmp_node {varId, *thenId, *elseId});
+    }
+
+    if (not isEnd || ssize(nodes) != nodeCount)
+    {
+        return std::nullopt;
+    }
+
+    return nodes;
+}
+
+inline auto dddmp_file::read_binary_nodes(
+    std::istream& ist,
+    std::vector<int32> const& suppIds,
+    int32 const suppCount,
+    int64 const nodeCount
+) -> std::optional<std::vector<dddmp_node>>
+{
+    // Each node is a code byte followed by optional integers for the
+    // variable, the then-son, and the else-son. The code byte consists
+    // of bits unused(1) var(2) then(2) else-complement(1) else(2).
+    // Variables are positions in the .ids list and may be relative
+    // to the topmost son, the leaf is below all variables.
+    std::vector<dddmp_node> nodes;
+    std::vector<int32> positions;
+    nodes.reserve(as_usize(nodeCount));
+    positions.reserve(as_usize(nodeCount));
+    for (int32 id = 1; id <= nodeCount; ++id)
+    {
+        std::optional<int32> const code = read_byte(ist);
+        if (not code)
+        {
+            return std::nullopt;
+        }
+
+        int32 const varCode  = (*code >> 5) & 3;
+        int32 const thenCode = (*code >> 3) & 3;
+        int32 const elseCode = *code & 3;
+        bool const isElseComplement = ((*code >> 2) & 1) == 1;
+        if (varCode == Terminal)
+        {
+            nodes.push_back(dddmp_node {1, 0, 0});
+            positions.push_back(suppCount);
+            continue;
+        }
+
+        std::optional<int32> var = 0;
+        if (varCode != Relative1)
+        {
+            var = read_int(ist);
+        }
+
+        auto const read_son = [&ist, id] (int32 const sonCode)
+            -> std::optional<int32>
+        {
+            if (sonCode == Terminal)
+            {
+                return 1;
+            }
+            if (sonCode == Relative1)
+            {
+                return id - 1;
+            }
+            std::optional<int32> const value = read_int(ist);
+            if (not value)
+            {
+                return std::nullopt;
+            }
+            return sonCode == RelativeId ? id - *value : *value;
+        };
+        std::optional<int32> const thenId = read_son(thenCode);
+        std::optional<int32> const elseId = read_son(elseCode);
+        if (not var || not thenId || not elseId
+            || not is_valid_son(*thenId, id) || not is_valid_son(*elseId, id))
+        {
+            return std::nullopt;
+        }
+
+        if (varCode != AbsoluteId)
+        {
+            int32 const top = utils::min(
+                positions[as_uindex(*thenId - 1)],
+                positions[as_uindex(*elseId - 1)]
+            );
+            var = top - (varCode == Relative1 ? 1 : *var);
+        }
+        if (*var < 0 || *var >= suppCount)
+        {
+            return std::nullopt;
+        }
+
+        int32 const varId = suppIds.empty() ? *var : suppIds[as_uindex(*var)];
+        nodes.push_back(
+            dddmp_node {varId, *thenId, isElseComplement ? -*elseId : *elseId}
+        );
+        positions.push_back(*var);
+    }
+
+    std::string line;
+    if (not std::getline(ist >> std::ws, line) || not line.starts_with(".end"))
+    {
+        return std::nullopt;
+    }
+
+    return nodes;
+}
+
+inline auto dddmp_file::write_binary_nodes(
+    std::ostream& out,
+    std::vector<dddmp_node> const& nodes,
+    std::vector<int32> const& positions,
+    int32 const suppCount
+) -> void
+{
+    assert(not nodes.empty() && nodes[0].then_ == 0);
+    write_byte(out, Terminal);
+    for (int32 id = 2; id <= ssize(nodes); ++id)
+    {
+        dddmp_node const& node  = nodes[as_uindex(id - 1)];
+        int32 const elseId      = node.else_ < 0 ? -node.else_ : node.else_;
+        int32 const position    = positions[as_uindex(id - 1)];
+        auto const get_position = [&] (int32 const sonId)
+        { return sonId == 1 ? suppCount : positions[as_uindex(sonId - 1)]; };
+        auto const get_son_code = [id] (int32 const sonId)
+        {
+            int32 const diff = id - sonId;
+            return sonId == 1 ? Terminal
+                 : diff == 1  ? Relative1
+                 : diff < sonId ? RelativeId
+                                : AbsoluteId;
+        };
+
+        int32 const varDiff = utils::min(
+                                  get_position(node.then_),
+                                  get_position(elseId)
+                              )
+                            - position;
+        int32 const varCode = varDiff == 1 ? Relative1
+                            : varDiff > 0 && varDiff < position ? RelativeId
+                                                                : AbsoluteId;
+        int32 const thenCode = get_son_code(node.then_);
+        int32 const elseCode = get_son_code(elseId);
+        write_byte(
+            out,
+            (varCode << 5) | (thenCode << 3) | ((node.else_ < 0 ? 1 : 0) << 2)
+                | elseCode
+        );
+
+        auto const write_son = [&out, id] (int32 const sonId, int32 const code)
+        {
+            if (code == RelativeId || code == AbsoluteId)
+            {
+                write_int(out, code == RelativeId ? id - sonId : sonId);
+            }
+        };
+        if (varCode != Relative1)
+        {
+            write_int(out, varCode == RelativeId ? varDiff : position);
+        }
+        write_son(node.then_, thenCode);
+        write_son(elseId, elseCode);
+    }
+}
+
+inline auto dddmp_file::is_valid_son(int32 const sonId, int32 const id)
+    -> bool
+{
+    // Sons must precede their parents. The id is compared without
+    // negating the son so that INT_MIN can not overflow.
+    return sonId != 0 && sonId < id && sonId > -id;
+}
+
+inline auto dddmp_file::read_byte(std::istream& ist) -> std::optional<int32>
+{
+    // Bytes 0x00, 0x0a, 0x0d, and 0x1a are escaped by 0x00.
+    int const byte = ist.get();
+    if (byte == std::istream::traits_type::eof())
+    {
+        return std::nullopt;
+    }
+    if (byte != 0x00)
+    {
+        return byte;
+    }
+
+    switch (ist.get())
+    {
+    case 0x00:
+        return 0x00;
+    case 0x01:
+        return 0x0a;
+    case 0x02:
+        return 0x0d;
+    case 0x03:
+        return 0x1a;
+    default:
+        return std::nullopt;
+    }
+}
+
+inline auto dddmp_file::read_int(std::istream& ist) -> std::optional<int32>
+{
+    // Seven bits per byte, most significant first, the lowest bit
+    // is set on all bytes except the last one.
+    int64 value = 0;
+    for (int32 i = 0; i < 5; ++i)
+    {
+        std::optional<int32> const byte = read_byte(ist);
+        if (not byte)
+        {
+            return std::nullopt;
+        }
+        value = (value << 7) | (*byte >> 1);
+        if ((*byte & 1) == 0)
+        {
+            // Undefined is the largest int32.
+            return value > Undefined
+                     ? std::nullopt
+                     : std::optional<int32>(static_cast<int32>(value));
+        }
+    }
+    return std::nullopt;
+}
+
+inline auto dddmp_file::write_byte(std::ostream& out, int32 const byte)
+    -> void
+{
+    int32 escaped = -1;
+    switch (byte)
+    {
+    case 0x00:
+        escaped = 0x00;
+        break;
+    case 0x0a:
+        escaped = 0x01;
+        break;
+    case 0x0d:
+        escaped = 0x02;
+        break;
+    case 0x1a:
+        escaped = 0x03;
+        break;
+    default:
+        break;
+    }
+
+    if (escaped == -1)
+    {
+        out.put(static_cast<char>(byte));
+    }
+    else
+    {
+        out.put(0x00);
+        out.put(static_cast<char>(escaped));
+    }
+}
+
+inline auto dddmp_file::write_int(std::ostream& out, int32 const value)
+    -> void
+{
+    assert(value >= 0);
+    int32 chunks[5] {};
+    int32 count = 0;
+    int32 rest  = value;
+    do
+    {
+        chunks[count++] = rest & 0x7f;
+        rest >>= 7;
+    } while (rest != 0);
+
+    for (int32 i = count - 1; i >= 0; --i)
+    {
+        write_byte(out, (chunks[i] << 1) | (i > 0 ? 1 : 0));
+    }
+}
+
+} // namespace teddy
+
+#endif
@@ -1,7 +1,11 @@
 #ifndef LIBTEDDY_DETAILS_DIAGRAM_MANAGER_HPP
 #define LIBTEDDY_DETAILS_DIAGRAM_MANAGER_HPP
 
+#include <libteddy/details/binary_format.hpp>
+#include <libteddy/details/compiled_diagram.hpp>
+#include <libteddy/details/dddmp_file.hpp>
 #include <libteddy/details/diagram.hpp>
+#include <libteddy/details/mapped_file.hpp>
 #include <libteddy/details/node_manager.hpp>
 #include <libteddy/details/operators.hpp>
 #include <libteddy/details/pla_file.hpp>
@@ -9,12 +13,21 @@
 #include <libteddy/details/tools.hpp>
 #include <libteddy/details/types.hpp>
 
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <concepts>
+#include <cstring>
+#include <fstream>
 #include <initializer_list>
 #include <iterator>
 #include <optional>
 #include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace teddy
@@ -59,6 +72,13 @@ concept expression_node = requires(Node node, int32 value) {
                               } -> std::same_as<Node const&>;
                           };
 
+template<class Node>
+concept has_operation_id = requires(Node node) {
+                               {
+                                   node.get_operation_id()
+                               } -> std::same_as<int32>;
+                           };
+
 template<class Degree>
 concept is_bdd = std::same_as<degrees::fixed<2>, Degree>;
 
@@ -72,7 +92,8 @@ concept int_to_int = requires(F function, int32 value) {
 enum class fold_type
 {
     Left,
-    Tree
+    Tree,
+    SizeOrdered
 };
 
 struct var_cofactor
@@ -81,6 +102,85 @@ struct var_cofactor
     int32 value_;
 };
 
+template<class Data, class Degree, class Domain>
+class diagram_manager;
+
+/**
+ *  \brief User-defined binary operation registered in a manager
+ *
+ *  Created by \c diagram_manager::register_operation . Results of the
+ *  operation are kept in the operation cache of the manager between
+ *  calls of \c apply in the same way as results of built-in operations.
+ *  It must only be used with the manager that created it.
+ */
+template<class F>
+class registered_operation
+{
+public:
+    /**
+     *  \brief Returns id of the operation in the operation cache
+     */
+    [[nodiscard]] auto get_id () const -> int32;
+
+    /**
+     *  \brief Returns true if the operation is commutative
+     */
+    [[nodiscard]] auto is_commutative () const -> bool;
+
+    /**
+     *  \brief Applies the operation to values of two terminal nodes
+     */
+    [[nodiscard]] auto operator() (int32 lhs, int32 rhs) const -> int32;
+
+private:
+    template<class Data, class Degree, class Domain>
+    friend class diagram_manager;
+
+    registered_operation(int32 id, bool isCommutative, F function);
+
+private:
+    int32 id_;
+    bool isCommutative_;
+    F function_;
+};
+
+template<class F>
+auto registered_operation<F>::get_id() const -> int32
+{
+    return id_;
+}
+
+template<class F>
+auto registered_operation<F>::is_commutative() const -> bool
+{
+    return isCommutative_;
+}
+
+template<class F>
+auto registered_operation<F>::operator() (
+    int32 const lhs,
+    int32 const rhs
+) const -> int32
+{
+    if (lhs == Nondetermined || rhs == Nondetermined)
+    {
+        return Nondetermined;
+    }
+    return static_cast<int32>(function_(lhs, rhs));
+}
+
+template<class F>
+registered_operation<F>::registered_operation(
+    int32 const id,
+    bool const isCommutative,
+    F function
+) :
+    id_(id),
+    isCommutative_(isCommutative),
+    function_(static_cast<F&&>(function))
+{
+}
+
 /**
  *  \class diagram_manager
  *  \brief Base class for all diagram managers that generically
@@ -211,6 +311,27 @@ public:
     template<std::ranges::input_range R>
     auto from_vector (R&& vector) -> diagram_t;
 
+    /**
+     *  \brief Creates diagram from a truth vector of a function using
+     *  multiple threads
+     *
+     *  The vector is split into aligned sub-cubes given by values of
+     *  variables on the top levels of the diagram. Sub-diagrams of the
+     *  sub-cubes are built in parallel in thread-local staging tables and
+     *  then merged into the manager. The resulting diagram is the same
+     *  as the one created by \c from_vector . The vector can be e.g.
+     *  a span obtained from \c mapped_file .
+     *
+     *  \tparam R Random access range type
+     *  \param vector Range representing the truth vector
+     *  Elements of the range must be convertible to int
+     *  \param threadCount Number of threads to use
+     *  \return Diagram representing function given by the truth vector
+     */
+    template<std::ranges::random_access_range R>
+    auto from_vector_parallel (R const& vector, int32 threadCount)
+        -> diagram_t;
+
     /**
      *  \brief Creates truth vector from the diagram
      *
@@ -228,6 +349,14 @@ public:
 
     /**
      *  \brief Creates truth vector from the diagram
+     *
+     *  The vector is created by expansion of the diagram where each node
+     *  fills a contiguous slab of the output. If \p out is a contiguous
+     *  iterator to \c int32 (e.g. pointer into a caller-provided or
+     *  memory-mapped buffer), slabs of shared subdiagrams and slabs
+     *  of skipped levels are block-copied instead of being expanded again.
+     *  In that case, the buffer must hold the whole truth vector.
+     *
      *  \tparam O Output iterator type
      *  \param diagram Diagram
      *  \param out Output iterator that is used to output the truth vector
@@ -238,6 +367,9 @@ public:
     /**
      *  \brief Creates BDDs defined by PLA file.
      *
+     *  Products of lines with the same output part are merged only
+     *  once and the result is shared by all of the functions.
+     *
      *  \tparam Foo Dummy template to enable SFINE.
      *  \param file PLA file loaded in the instance of \c pla_file class.
      *  \param foldType fold type used in diagram creation.
@@ -248,8 +380,122 @@ public:
     auto from_pla (pla_file const& file, fold_type foldType = fold_type::Tree)
         -> utils::second_t<Foo, std::vector<diagram_t>>;
 
+    /**
+     *  \brief Creates BDDs defined by PLA file that is read as a stream.
+     *
+     *  Lines are read from \p stream in blocks. Products of each block
+     *  are merged and added to the result so that the whole file never
+     *  needs to be materialized.
+     *
+     *  \tparam Foo Dummy template to enable SFINE.
+     *  \param stream PLA file opened by \c pla_stream::open_file .
+     *  \param foldType fold type used to merge products of a block.
+     *  \return Vector of diagrams or \c std::nullopt if the file
+     *  contains a malformed line.
+     */
+    template<class Foo = void>
+    requires(is_bdd<Degree>)
+    auto from_pla (pla_stream& stream, fold_type foldType = fold_type::Tree)
+        -> utils::second_t<Foo, std::optional<std::vector<diagram_t>>>;
+
+    /**
+     *  \brief Creates BDDs defined by PLA file using multiple threads.
+     *
+     *  Functions are distributed among threads. Each thread builds
+     *  its functions in its own manager with the same order of variables.
+     *  Results are then transferred into this manager.
+     *  Result is the same as for \c from_pla .
+     *
+     *  \tparam Foo Dummy template to enable SFINE.
+     *  \param file PLA file loaded in the instance of \c pla_file class.
+     *  \param threadCount Number of threads to use.
+     *  \param foldType fold type used in diagram creation.
+     *  \return Vector of diagrams.
+     */
+    template<class Foo = void>
+    requires(is_bdd<Degree>)
+    auto from_pla_parallel (
+        pla_file const& file,
+        int32 threadCount,
+        fold_type foldType = fold_type::Tree
+    ) -> utils::second_t<Foo, std::vector<diagram_t>>;
+
+    /**
+     *  \brief Copies diagram from another manager into this manager.
+     *
+     *  Both managers must have the same number of variables, the same
+     *  domains and the same order of variables. The \p source manager
+     *  is only read.
+     *
+     *  \param source Manager that owns \p diagram
+     *  \param diagram Diagram from the \p source manager
+     *  \return Equivalent diagram owned by this manager
+     */
+    auto transfer (diagram_manager const& source, diagram_t const& diagram)
+        -> diagram_t;
+
+    /**
+     *  \brief Creates BDDs stored in the DDDMP format (e.g. by CUDD).
+     *
+     *  If the order of variables in the file agrees with the order
+     *  of this manager, nodes are created directly and the time is linear
+     *  in the number of nodes in the file. Otherwise, each node is created
+     *  using \c apply . Complemented edges are resolved during the loading.
+     *
+     *  \tparam Foo Dummy template to enable SFINE.
+     *  \param file DDDMP file loaded in the instance of \c dddmp_file class.
+     *  \param varIds \c varIds[i] is the DDDMP id of the i-th variable.
+     *  If empty, ids are the same as indices.
+     *  \return Vector of diagrams in the order of \c .rootids or
+     *  \c std::nullopt if the file refers to an unknown variable
+     *  or contains a leaf that is not 0 or 1
+     */
+    template<class Foo = void>
+    requires(is_bdd<Degree>)
+    auto from_dddmp (
+        dddmp_file const& file,
+        std::vector<int32> const& varIds = {}
+    ) -> utils::second_t<Foo, std::optional<std::vector<diagram_t>>>;
+
+    /**
+     *  \brief Prints BDDs in the DDDMP format.
+     *
+     *  Nodes shared by the diagrams are printed only once. Since DDDMP
+     *  uses complemented edges, nodes are printed such that then-edges
+     *  are never complemented and there is a single leaf, as expected
+     *  by \c Dddmp_cuddBddLoad .
+     *
+     *  \tparam Foo Dummy template to enable SFINE.
+     *  \param out Output stream (e.g. \c std::cout or \c std::ofstream ),
+     *  must be opened in binary mode if \p mode is \c dddmp_mode::Binary
+     *  \param diagrams Diagrams to be printed
+     *  \param varIds \c varIds[i] is the DDDMP id of the i-th variable.
+     *  If empty, ids are the same as indices.
+     *  \param mode Encoding of the node table
+     */
+    template<class Foo = void>
+    requires(is_bdd<Degree>)
+    auto to_dddmp (
+        std::ostream& out,
+        std::vector<diagram_t> const& diagrams,
+        std::vector<int32> const& varIds = {},
+        dddmp_mode mode                  = dddmp_mode::Text
+    ) const -> utils::second_t<Foo, void>;
+
     /**
      *  \brief Creates diagram from an expression tree (AST).
+     *
+     *  The expression can also be a DAG where subexpressions are shared
+     *  by multiple parents, e.g., gates of a fault tree. Subexpressions
+     *  are identified by their address and each is built exactly once.
+     *  The expression is traversed iteratively so deep expressions do not
+     *  overflow the stack.
+     *
+     *  If \p Node provides <tt>int32 get_operation_id()</tt> , operation
+     *  nodes with the same id must compute the same operation and share
+     *  the apply cache within the call. Otherwise, each operation node
+     *  uses its own cache entries.
+     *
      *  \tparam Node Node type of the tree.
      *          Must provide API given by the concept.
      *          Required API might change in the future.
@@ -303,15 +549,124 @@ public:
     auto apply (diagram_t const& lhs, diagram_t const& rhs) -> diagram_t;
 
     /**
-     *  \brief TODO
+     *  \brief Merges all diagrams in one pass using given binary operation.
+     *
+     *  Unlike folds, no intermediate diagrams are created.
+     *
+     *  \code
+     *  // Example:
+     *  manager.apply_n<teddy::ops::AND>(bdd1, bdd2, bdd3);
+     *  \endcode
+     *
+     *  \tparam Op Associative binary operation
+     *  \param diagrams Diagrams to merge
+     *  \return Diagram representing merger of \p diagrams
      */
     template<teddy_bin_op Op, class... Diagram>
-    auto apply_n (Diagram const&... diagrams) -> diagram_t;
+    auto apply_n (Diagram const&... diagrams) -> diagram_t
+        requires(utils::same_as<Diagram, diagram_t> && ...);
+
+    /**
+     *  \brief Merges all diagrams in one pass using given binary operation.
+     *
+     *  Runtime-arity version of the variadic \c apply_n . Recursion stops
+     *  as soon as the terminal sons determine the result, e.g., when
+     *  one of them is 0 in case of AND and MIN. This is usually faster
+     *  than folds when merging many diagrams with AND, OR, MIN, or MAX.
+     *
+     *  \code
+     *  // Example:
+     *  std::vector<diagram_t> vs = manager.variables({0, 1, 2});
+     *  diagram_t product = manager.apply_n<teddy::ops::AND>(vs);
+     *  \endcode
+     *
+     *  \tparam Op Associative binary operation
+     *  \param diagrams Diagrams to merge, must not be empty
+     *  \return Diagram representing merger of \p diagrams
+     */
+    template<teddy_bin_op Op>
+    auto apply_n (std::span<diagram_t const> diagrams) -> diagram_t;
+
+    /**
+     *  \brief Creates BDD of if-then-else: \p f ? \p g : \p h
+     *
+     *  Computes the result in a single pass without intermediate
+     *  diagrams, which is faster than combining AND, OR, and NOT.
+     *
+     *  \param f Condition
+     *  \param g Value where \p f is 1
+     *  \param h Value where \p f is 0
+     *  \return Diagram representing the if-then-else
+     */
+    template<class Foo = void>
+    requires(is_bdd<Degree>)
+    auto ite (diagram_t const& f, diagram_t const& g, diagram_t const& h)
+        -> utils::second_t<Foo, diagram_t>;
+
+    /**
+     *  \brief Creates diagram that uses value of \p selector to choose
+     *  one of the \p branches
+     *
+     *  Generalization of \c ite for MDDs. The result is
+     *  \c branches[selector(x)](x) for each input \c x . Computes the
+     *  result in a single pass without intermediate diagrams.
+     *
+     *  \param selector Diagram selecting the branch
+     *  \param branches Diagrams to choose from, must contain branch for
+     *  each value of \p selector
+     *  \return Diagram representing the selection
+     */
+    auto case_of (
+        diagram_t const& selector,
+        std::span<diagram_t const> branches
+    ) -> diagram_t;
+
+    /**
+     *  \brief Registers user-defined binary operation
+     *
+     *  The operation gets its own id in the operation cache of this
+     *  manager. Hence, unlike lambdas passed to other functions,
+     *  its results are reused between calls of \c apply . Ids are not
+     *  reused, a manager can register at most 1'047'552 operations,
+     *  further calls throw \c std::runtime_error .
+     *
+     *  \code
+     *  // Example:
+     *  auto const absDiff = manager.register_operation(
+     *      [] (int32 l, int32 r) { return l < r ? r - l : l - r; },
+     *      true
+     *  );
+     *  diagram_t d = manager.apply(absDiff, mdd1, mdd2);
+     *  \endcode
+     *
+     *  \param function Callable taking two values of terminal nodes
+     *  and returning value of the result
+     *  \param isCommutative True if the operation is commutative.
+     *  Allows the cache to store the result only once.
+     *  \return Registered operation that can be used in \c apply
+     */
+    template<class F>
+    auto register_operation (F function, bool isCommutative = false)
+        -> registered_operation<F>;
+
+    /**
+     *  \brief Merges two diagrams using registered operation
+     *  \param operation Operation created by \c register_operation
+     *  \param lhs first diagram
+     *  \param rhs second diagram
+     *  \return Diagram representing merger of \p lhs and \p rhs
+     */
+    template<class F>
+    auto apply (
+        registered_operation<F> const& operation,
+        diagram_t const& lhs,
+        diagram_t const& rhs
+    ) -> diagram_t;
 
     // TODO apply_own
 
     /**
-     *  \brief Merges diagams in the range using the \c apply function
+     *  \brief Merges diagrams in the range using the \c apply function
      *  and binary operation
      *
      *  Uses left fold order of evaluation (sequentially from the left).
@@ -331,7 +686,7 @@ public:
     auto left_fold (R const& diagrams) -> diagram_t;
 
     /**
-     *  \brief Merges diagams in the range using the \c apply function
+     *  \brief Merges diagrams in the range using the \c apply function
      *  and binary operation
      *
      *  Uses left fold order of evaluation (sequentially from the left).
@@ -354,7 +709,7 @@ public:
     auto left_fold (I first, S last) -> diagram_t;
 
     /**
-     *  \brief Merges diagams in the range using the \c apply function
+     *  \brief Merges diagrams in the range using the \c apply function
      *  and binary operation
      *
      *  Uses tree fold order of evaluation ((d1 op d2) op (d3 op d4) ...) .
@@ -377,7 +732,7 @@ public:
     auto tree_fold (R& diagrams) -> diagram_t;
 
     /**
-     *  \brief Merges diagams in the range using the \c apply function
+     *  \brief Merges diagrams in the range using the \c apply function
      *  and binary operation
      *
      *  Uses tree fold order of evaluation ((d1 op d2) op (d3 op d4) ...) .
@@ -404,6 +759,73 @@ public:
         std::sentinel_for<I> S>
     auto tree_fold (I first, S last) -> diagram_t;
 
+    /**
+     *  \brief Merges diagrams in the range using the \c apply function
+     *  and binary operation using multiple threads
+     *
+     *  The range is split into \p threadCount contiguous parts. Each part
+     *  is copied into a separate manager with the same order of variables
+     *  and merged using \c tree_fold in its own thread. Results of the
+     *  parts are then copied back into this manager and merged. For an
+     *  associative \p Op , the result is the same as for \c tree_fold .
+     *
+     *  \code
+     *  // Example:
+     *  std::vector<diagram_t> vs = manager.variables({0, 1, 2, 3});
+     *  diagram_t sum = manager.tree_fold_parallel<teddy::ops::OR>(vs, 2);
+     *  \endcode
+     *
+     *  \tparam Op Associative binary operation
+     *  \tparam R Range containing diagrams (e.g. std::vector<diagram_t>)
+     *  \param diagrams Random access range of diagrams to be merged
+     *  \param threadCount Number of threads to use
+     *  \return Diagram representing merger of all diagrams from the range
+     */
+    template<teddy_bin_op Op, std::ranges::random_access_range R>
+    auto tree_fold_parallel (R const& diagrams, int32 threadCount)
+        -> diagram_t;
+
+    /**
+     *  \brief Merges diagrams in the range using the \c apply function
+     *  and binary operation
+     *
+     *  Always merges the two smallest diagrams (in terms of the number
+     *  of nodes) which keeps the intermediate results small. Sizes
+     *  are computed only once for each diagram. Uses the input range
+     *  \p diagrams to store some intermediate results. \p diagrams
+     *  is left in valid but unspecified state. The range must not
+     *  be empty.
+     *
+     *  \code
+     *  // Example:
+     *  std::vector<diagram_t> vs = manager.variables({0, 1, 2});
+     *  diagram_t product = manager.size_ordered_fold<teddy::ops::AND>(vs);
+     *  \endcode
+     *
+     *  \tparam Op Associative and commutative binary operation
+     *  \tparam R Range containing diagrams (e.g. std::vector<diagram_t>)
+     *  \param diagrams Random access range of diagrams to be merged
+     *  \return Diagram representing merger of all diagrams from the range
+     */
+    template<teddy_bin_op Op, std::ranges::random_access_range R>
+    auto size_ordered_fold (R& diagrams) -> diagram_t;
+
+    /**
+     *  \brief Merges diagrams in the range using the \c apply function
+     *  and binary operation using given fold strategy
+     *
+     *  Calls \c left_fold , \c tree_fold , or \c size_ordered_fold .
+     *  \p diagrams is left in valid but unspecified state.
+     *
+     *  \tparam Op Binary operation
+     *  \tparam R Range containing diagrams (e.g. std::vector<diagram_t>)
+     *  \param diagrams Random access range of diagrams to be merged
+     *  \param foldType Fold strategy
+     *  \return Diagram representing merger of all diagrams from the range
+     */
+    template<teddy_bin_op Op, std::ranges::random_access_range R>
+    auto fold (R& diagrams, fold_type foldType) -> diagram_t;
+
     /**
      *  \brief Evaluates value of the function represented by the diagram
      *
@@ -419,6 +841,78 @@ public:
     template<in_var_values Vars>
     auto evaluate (diagram_t const& diagram, Vars const& values) const -> int32;
 
+    /**
+     *  \brief Evaluates value of the function for many variable assignments
+     *
+     *  The diagram is first flattened into a compact array of nodes
+     *  ordered by levels. Assignments are then processed in blocks.
+     *  All assignments of a block advance through the array together
+     *  so that the inner loop has no dependencies between iterations.
+     *  For large number of assignments this is considerably faster
+     *  than calling \c evaluate in a loop. If the same diagram is
+     *  evaluated in many batches, \c compile it once and use
+     *  \c compiled_diagram::evaluate_many instead.
+     *
+     *  \tparam Vs Random access range of containers that hold
+     *  values of variables (e.g. std::vector<std::vector<int>>)
+     *  \tparam O Output iterator type
+     *  \param diagram Diagram
+     *  \param assignments Range of variable assignments
+     *  \param out Output iterator that is used to output values of the
+     *  function in the same order as are the assignments
+     */
+    template<std::ranges::random_access_range Vs, std::output_iterator<int32> O>
+    auto evaluate_many (diagram_t const& diagram, Vs const& assignments, O out)
+        const -> void;
+
+    /**
+     *  \brief Creates immutable flat snapshot of the diagram
+     *
+     *  The snapshot stores nodes in a contiguous array ordered by levels
+     *  and does not depend on the manager. It can be used for repeated
+     *  read-only queries (evaluation, satisfy count, probabilities)
+     *  even from multiple threads while the manager is used for something
+     *  else.
+     *
+     *  \param diagram Diagram
+     *  \return Compiled diagram
+     */
+    auto compile (diagram_t const& diagram) const -> compiled_diagram;
+
+    /**
+     *  \brief Simulates BDD for many input patterns at once
+     *
+     *  Each bit of the input words represents value of a variable
+     *  in one input pattern i.e., a single word holds 64 patterns.
+     *  The diagram is simulated bottom-up where each node computes
+     *  a bitwise multiplexer of its sons, so a single visit of a node
+     *  evaluates all of the patterns.
+     *
+     *  \code
+     *  // Example: 128 patterns for a function of 3 variables.
+     *  std::vector<std::vector<teddy::uint64>> columns {
+     *      {x0word0, x0word1},
+     *      {x1word0, x1word1},
+     *      {x2word0, x2word1}
+     *  };
+     *  std::vector<teddy::uint64> fs = manager.simulate_bits(f, columns);
+     *  \endcode
+     *
+     *  \tparam Foo Dummy template to enable SFINE.
+     *  \param diagram Diagram
+     *  \param columns Bit columns for each variable. Vector at index i
+     *  holds the values of the i-th variable. Must contain column for
+     *  each variable and all of the columns must have the same size.
+     *  \return Bit vector (of the same size as are the columns)
+     *  with values of the function for each pattern
+     */
+    template<class Foo = void>
+    requires(is_bdd<Degree>)
+    auto simulate_bits (
+        diagram_t const& diagram,
+        std::vector<std::vector<uint64>> const& columns
+    ) const -> utils::second_t<Foo, std::vector<uint64>>;
+
     /**
      *  \brief Calculates number of variable assignments for which
      *  the functions evaluates to certain value
@@ -515,49 +1009,220 @@ public:
     ) -> diagram_t;
 
     /**
-     *  \brief Transforms values of the function
+     *  \brief Calculates generalized cofactor of the function
+     *
+     *  Coudert-Madre constrain operator. The result agrees with \c f
+     *  where the care set \c c is 1 and is usually smaller than \c f .
+     *  It maps each point outside of the care set to the value of
+     *  a nearby point inside of it, so it may depend on variables
+     *  that \c f does not depend on.
+     *
+     *  \param diagram Diagram representing the function \c f
+     *  \param careSet Diagram representing the care set \c c , must
+     *  have values 0 and 1 and must not be constant 0
+     *  \return Diagram representing generalized cofactor \c f|c
+     */
+    auto constrain (diagram_t const& diagram, diagram_t const& careSet)
+        -> diagram_t;
+
+    /**
+     *  \brief Restricts the function to the care set
+     *
+     *  Coudert-Madre restrict operator. Same as \c constrain
+     *  but variables of the care set that \c f does not depend on are
+     *  abstracted from the care set first. Hence the result depends
+     *  only on variables of \c f . If the result would be larger than
+     *  \c f , \c f is returned instead.
+     *
+     *  \param diagram Diagram representing the function \c f
+     *  \param careSet Diagram representing the care set \c c , must
+     *  have values 0 and 1 and must not be constant 0
+     *  \return Diagram that agrees with \c f where \c c is 1
+     */
+    auto restrict (diagram_t const& diagram, diagram_t const& careSet)
+        -> diagram_t;
+
+    /**
+     *  \brief Merges all cofactors with respect to given variables
+     *  using binary operation
+     *
+     *  For a single variable \c x_i with domain \c m , the result is
+     *  \c Op(...Op(Op(f|x_i=0,f|x_i=1),f|x_i=2)...,f|x_i=m-1) . It is
+     *  calculated in a single pass without creating the cofactors.
+     *  Cofactors of multiple variables are merged in an order given
+     *  by the diagram, hence the operation must be associative.
      *
      *  \code
-     *  // Example of the call with 4-valued MDD.
-     *  manager.transform(diagram, [](int v)
-     *  {
-     *      return 3 - v;
-     *  });
+     *  // Example: the best state of the system over all states
+     *  // of the components 0 and 1.
+     *  diagram_t best = manager.abstract<teddy::ops::MAX>(sf, {0, 1});
      *  \endcode
      *
-     *  \tparam F Type of the transformation function
+     *  \tparam Op Commutative and associative binary operation, i.e.,
+     *  \c AND , \c OR , \c XOR , \c MIN , \c MAX , \c PLUS ,
+     *  or \c MULTIPLIES
      *  \param diagram Diagram representing the function
-     *  \param transformer Transformation function that is applied
-     *  to values of the function.
-     *  \return Diagram representing transformed function
+     *  \param varIndices Indices of abstracted variables
+     *  \return Diagram representing the abstracted function
      */
-    template<int_to_int F>
-    auto transform (diagram_t const& diagram, F transformer) -> diagram_t;
+    template<teddy_bin_op Op>
+    requires(Op::is_commutative() && details::is_associative<Op>::value)
+    auto abstract (
+        diagram_t const& diagram,
+        std::vector<int32> const& varIndices
+    ) -> diagram_t;
 
     /**
-     *  \brief Negates Boolean function
+     *  \brief Existential quantification of variables
+     *
+     *  Calculates disjunction of all cofactors of the function with
+     *  respect to the variables in \p varIndices in a single pass.
+     *
      *  \param diagram Diagram representing the function
-     *  \param transformer Transformation function that is applied
-     *  to values of the function.
-     *  \return Diagram representing transformed function
+     *  \param varIndices Indices of quantified variables
+     *  \return Diagram representing the quantified function
      */
     template<class Foo = void>
     requires(is_bdd<Degree>)
-    auto negate (diagram_t const& diagram) -> utils::second_t<Foo, diagram_t>;
+    auto exists (
+        diagram_t const& diagram,
+        std::vector<int32> const& varIndices
+    ) -> utils::second_t<Foo, diagram_t>;
 
     /**
-     *  \brief Enumerates indices of variables that the function depends on
+     *  \brief Universal quantification of variables
+     *
+     *  Calculates conjunction of all cofactors of the function with
+     *  respect to the variables in \p varIndices in a single pass.
+     *
      *  \param diagram Diagram representing the function
-     *  \return Vector of indices
+     *  \param varIndices Indices of quantified variables
+     *  \return Diagram representing the quantified function
      */
-    auto get_dependency_set (diagram_t const& diagram) const
-        -> std::vector<int32>;
+    template<class Foo = void>
+    requires(is_bdd<Degree>)
+    auto forall (
+        diagram_t const& diagram,
+        std::vector<int32> const& varIndices
+    ) -> utils::second_t<Foo, diagram_t>;
 
     /**
-     *  \brief Enumerates indices of variables that the function depends on
-     *  \tparam O Output iterator type.
-     *  \param diagram Diagram representing the function.
-     *  \param out Output iterator that is used to output indices.
+     *  \brief Existential quantification of conjunction (relational product)
+     *
+     *  Calculates \c exists(lhs AND rhs, varIndices) without creating
+     *  the diagram of the conjunction.
+     *
+     *  \param lhs First diagram
+     *  \param rhs Second diagram
+     *  \param varIndices Indices of quantified variables
+     *  \return Diagram representing the quantified conjunction
+     */
+    template<class Foo = void>
+    requires(is_bdd<Degree>)
+    auto and_exists (
+        diagram_t const& lhs,
+        diagram_t const& rhs,
+        std::vector<int32> const& varIndices
+    ) -> utils::second_t<Foo, diagram_t>;
+
+    /**
+     *  \brief Substitutes function for a variable
+     *
+     *  Calculates \c f[x_i:=g] in a single pass. Values of \p replacement
+     *  must be in the domain of the substituted variable.
+     *
+     *  \param diagram Diagram representing the function \c f
+     *  \param varIndex Index \c i of the substituted variable
+     *  \param replacement Diagram representing the function \c g
+     *  \return Diagram representing the composition
+     */
+    auto compose (
+        diagram_t const& diagram,
+        int32 varIndex,
+        diagram_t const& replacement
+    ) -> diagram_t;
+
+    /**
+     *  \brief Simultaneously substitutes functions for all variables
+     *
+     *  Calculates \c f(g_0,g_1,...,g_n) in a single pass. Variables
+     *  that should not change can be replaced by themselves, e.g.,
+     *  \c replacements[i] = manager.variable(i) .
+     *
+     *  \param diagram Diagram representing the function \c f
+     *  \param replacements \c replacements[i] replaces the \c i th
+     *  variable, must contain replacement for each variable
+     *  \return Diagram representing the composition
+     */
+    auto vector_compose (
+        diagram_t const& diagram,
+        std::vector<diagram_t> const& replacements
+    ) -> diagram_t;
+
+    /**
+     *  \brief Renames variables of a function
+     *
+     *  Calculates \c f(x_m[0],x_m[1],...,x_m[n]) where \c m is the
+     *  \p mapping . If the mapping preserves the relative order of
+     *  the variables \c f depends on, the diagram is relabelled in
+     *  a single linear pass. Otherwise, it is rebuilt using
+     *  the vector composition.
+     *
+     *  \param diagram Diagram representing the function \c f
+     *  \param mapping \c mapping[i] is the new index of the \c i th
+     *  variable, must contain new index for each variable, domains of
+     *  the old and the new variable must be the same
+     *  \return Diagram representing the renamed function
+     */
+    auto rename (
+        diagram_t const& diagram,
+        std::vector<int32> const& mapping
+    ) -> diagram_t;
+
+    /**
+     *  \brief Transforms values of the function
+     *
+     *  \code
+     *  // Example of the call with 4-valued MDD.
+     *  manager.transform(diagram, [](int v)
+     *  {
+     *      return 3 - v;
+     *  });
+     *  \endcode
+     *
+     *  \tparam F Type of the transformation function
+     *  \param diagram Diagram representing the function
+     *  \param transformer Transformation function that is applied
+     *  to values of the function.
+     *  \return Diagram representing transformed function
+     */
+    template<int_to_int F>
+    auto transform (diagram_t const& diagram, F transformer) -> diagram_t;
+
+    /**
+     *  \brief Negates Boolean function
+     *  \param diagram Diagram representing the function
+     *  \param transformer Transformation function that is applied
+     *  to values of the function.
+     *  \return Diagram representing transformed function
+     */
+    template<class Foo = void>
+    requires(is_bdd<Degree>)
+    auto negate (diagram_t const& diagram) -> utils::second_t<Foo, diagram_t>;
+
+    /**
+     *  \brief Enumerates indices of variables that the function depends on
+     *  \param diagram Diagram representing the function
+     *  \return Vector of indices
+     */
+    auto get_dependency_set (diagram_t const& diagram) const
+        -> std::vector<int32>;
+
+    /**
+     *  \brief Enumerates indices of variables that the function depends on
+     *  \tparam O Output iterator type.
+     *  \param diagram Diagram representing the function.
+     *  \param out Output iterator that is used to output indices.
      */
     template<std::output_iterator<int32> O>
     auto get_dependency_set_g (diagram_t const& diagram, O out) const -> void;
@@ -615,6 +1280,97 @@ public:
     auto to_dot_graph (std::ostream& out, diagram_t const& diagram) const
         -> void;
 
+    /**
+     *  \brief Prints dot representation of a part of the diagram
+     *
+     *  Useful for diagrams that are too large to be rendered. Only nodes
+     *  with level in <tt>[levelFrom, levelTo)</tt> are printed, terminal
+     *  nodes are at level \c get_var_count() . At most \p maxNodeCount
+     *  nodes are printed, starting from the top level, a negative
+     *  \p maxNodeCount is treated as 0. Arcs leading to nodes that are
+     *  not printed point to a single node labeled "...".
+     *
+     *  Nodes are written level by level as they are discovered, arcs
+     *  follow once all printed nodes are known. Levels below the window
+     *  are not visited and the traversal stops once \p maxNodeCount
+     *  nodes are printed. Nodes above the window still have to be
+     *  visited to find the ones inside it.
+     *
+     *  \param out Output stream (e.g. \c std::cout or \c std::ofstream )
+     *  \param diagram Diagram
+     *  \param levelFrom First level to be printed
+     *  \param levelTo Level after the last level to be printed
+     *  \param maxNodeCount Maximal number of printed nodes
+     */
+    auto to_dot_graph (
+        std::ostream& out,
+        diagram_t const& diagram,
+        int32 levelFrom,
+        int32 levelTo,
+        int64 maxNodeCount
+    ) const -> void;
+
+    /**
+     *  \brief Prints standalone C++ source of the evaluation function
+     *
+     *  Prints definition of function \c int \p name(int const* x)
+     *  that evaluates the diagram for variable values \c x without
+     *  any dependency on the library. See
+     *  \c compiled_diagram::to_cpp_source for details.
+     *
+     *  \param out Output stream (e.g. \c std::cout or \c std::ofstream )
+     *  \param diagram Diagram
+     *  \param name Name of the generated function
+     *  \param withAvailability Whether to also print function
+     *  \c name_availability(double const* const* p, int state)
+     */
+    auto to_cpp_source (
+        std::ostream& out,
+        diagram_t const& diagram,
+        std::string_view name,
+        bool withAvailability = false
+    ) const -> void;
+
+    /**
+     *  \brief Saves diagrams into a binary file
+     *
+     *  The file contains order and domains of variables, values of
+     *  terminal nodes, and a level-ordered table of nodes shared by all
+     *  \p diagrams . Sons are stored as indices into the table using
+     *  the smallest sufficient number of bytes. Use \c load to load
+     *  the diagrams back.
+     *
+     *  \param diagrams Diagrams to be saved
+     *  \param path Path to the file
+     *  \return True if the file was written successfully
+     */
+    auto save (std::vector<diagram_t> const& diagrams, std::string const& path)
+        const -> bool;
+
+    /**
+     *  \brief Saves diagram into a binary file
+     *  \param diagram Diagram to be saved
+     *  \param path Path to the file
+     *  \return True if the file was written successfully
+     */
+    auto save (diagram_t const& diagram, std::string const& path) const
+        -> bool;
+
+    /**
+     *  \brief Loads diagrams saved by \c save
+     *
+     *  Order and domains of variables in the file must be the same as in
+     *  this manager. Each record goes through the unique table so that
+     *  duplicate records in a damaged file are merged.
+     *
+     *  \param path Path to the file
+     *  \return Diagrams in the same order as they were saved or
+     *  \c std::nullopt if the file could not be read, is malformed, or has
+     *  different order or domains
+     */
+    auto load (std::string const& path)
+        -> std::optional<std::vector<diagram_t>>;
+
     /**
      *  \brief Runs garbage collection.
      *
@@ -717,6 +1473,58 @@ private:
         node_t* result_ {nullptr};
     };
 
+    /**
+     *  \brief Direct-mapped cache for the runtime-arity \c apply_n
+     *
+     *  Each entry holds \c arity_ keys followed by the result. The cache
+     *  grows when the number of stored entries reaches its capacity.
+     */
+    struct node_span_cache
+    {
+        int64 arity_;
+        int64 capacity_;
+        int64 maxCapacity_;
+        int64 putCount_;
+        std::vector<node_t*> entries_;
+    };
+
+    /**
+     *  \brief Set of variables that are abstracted (quantified)
+     */
+    struct abstracted_vars
+    {
+        std::vector<bool> isAbstracted_;
+        int32 lastLevel_;
+
+        /**
+         *  \brief Results merged by apply, they stay marked until
+         *  the operation finishes
+         */
+        std::vector<node_t*> operands_;
+    };
+
+    /**
+     *  \brief State of the (vector) composition
+     */
+    struct composition
+    {
+        /**
+         *  \brief Replacement of each variable, nullptr if the
+         *  variable is not replaced, empty in \c compose
+         */
+        std::vector<node_t*> replacements_;
+        int32 lastLevel_;
+        int32 opId_;
+        int64 nodeCount_;
+
+        /**
+         *  \brief Caches for \c case_of_impl indexed by the domain
+         */
+        std::vector<node_span_cache> caseCaches_;
+        std::vector<node_t*> stack_;
+        std::vector<node_t*> operands_;
+    };
+
     // TODO tmp
     template<int32 Size, class... Node>
     static auto pack_equals (node_pack<Size> const& pack, Node... nodes)
@@ -741,6 +1549,15 @@ private:
     template<class Op>
     auto apply_impl (Op operation, node_t* lhs, node_t* rhs) -> node_t*;
 
+    template<class Op>
+    auto apply_dynamic_impl (
+        int32 opId,
+        bool isCommutative,
+        Op const& operation,
+        node_t* lhs,
+        node_t* rhs
+    ) -> node_t*;
+
     template<class Op, class... Node>
     auto apply_n_impl (
         std::vector<node_pack<sizeof...(Node)>>& cache,
@@ -748,6 +1565,126 @@ private:
         Node... nodes
     ) -> node_t*;
 
+    template<class Op>
+    auto apply_n_impl (
+        node_span_cache& cache,
+        std::vector<node_t*>& stack,
+        Op operation,
+        int64 offset
+    ) -> node_t*;
+
+    auto ite_impl (
+        node_span_cache& cache,
+        node_t* zero,
+        node_t* one,
+        node_t* f,
+        node_t* g,
+        node_t* h
+    ) -> node_t*;
+
+    auto case_of_impl (
+        node_span_cache& cache,
+        std::vector<node_t*>& stack,
+        int64 offset
+    ) -> node_t*;
+
+    auto compose_impl (
+        composition& comp,
+        int32 varIndex,
+        node_t* node,
+        node_t* replacement
+    ) -> node_t*;
+
+    auto vector_compose_impl (composition& comp, node_t* node) -> node_t*;
+
+    auto rename_impl (
+        std::unordered_map<node_t*, node_t*>& memo,
+        std::vector<int32> const& mapping,
+        node_t* node
+    ) -> node_t*;
+
+    auto compose_case_impl (
+        composition& comp,
+        node_t* selector,
+        son_container const& branches,
+        int32 domain
+    ) -> node_t*;
+
+    static auto apply_n_max_capacity (int64 arity) -> int64;
+
+    static auto make_node_span_cache (int64 arity, int64 nodeCount)
+        -> node_span_cache;
+
+    static auto apply_n_cache_find (
+        node_span_cache const& cache,
+        node_t* const* keys,
+        std::size_t hash
+    ) -> node_t*;
+
+    static auto apply_n_cache_put (
+        node_span_cache& cache,
+        node_t* const* keys,
+        std::size_t hash,
+        node_t* result
+    ) -> void;
+
+    static auto apply_n_cache_hash (node_t* const* keys, int64 arity)
+        -> std::size_t;
+
+    template<class GetValue>
+    auto cube_product_impl (int32 size, GetValue getValue) -> diagram_t;
+
+    template<class IsInFunction, class MakeProduct>
+    auto sum_of_products_impl (
+        int64 lineCount,
+        int32 functionCount,
+        IsInFunction isInFunction,
+        MakeProduct makeProduct,
+        fold_type foldType
+    ) -> std::vector<diagram_t>;
+
+    auto make_worker_impl () const -> diagram_manager;
+
+    auto transfer_impl (
+        node_t* node,
+        std::unordered_map<node_t*, node_t*>& memo
+    ) -> node_t*;
+
+    auto from_dddmp_impl (
+        std::vector<dddmp_file::dddmp_node> const& nodes,
+        std::vector<int32> const& indices,
+        std::vector<node_t*>& memo,
+        int32 id
+    ) -> node_t*;
+
+    auto from_dddmp_apply_impl (
+        std::vector<dddmp_file::dddmp_node> const& nodes,
+        std::vector<int32> const& indices,
+        std::vector<diagram_t>& memo,
+        int32 id
+    ) -> diagram_t;
+
+    template<class I>
+    auto stage_vector_impl (
+        I first,
+        int32 level,
+        std::vector<int32>& records,
+        std::unordered_multimap<std::size_t, int32>& unique,
+        std::vector<int32>& stack
+    ) const -> int32;
+
+    auto to_flat_impl (node_t* root, std::vector<int32>& flat) const -> int32;
+
+    template<class O>
+    auto to_vector_impl (node_t* node, int32 level, O& out) const -> void;
+
+    auto to_vector_impl (
+        node_t* node,
+        int32 level,
+        int32* out,
+        std::unordered_map<node_t*, int32 const*>& memo
+    ) const -> void;
+
     template<class Vars>
     auto satisfy_one_impl (int32 value, Vars& vars, node_t* node) -> bool;
 
@@ -774,6 +1711,36 @@ private:
         int32 toCofactor
     ) -> node_t*;
 
+    auto make_abstracted_vars (std::vector<int32> const& varIndices) const
+        -> abstracted_vars;
+
+    template<class Op>
+    auto abstract_impl (
+        Op operation,
+        int32 opId,
+        abstracted_vars& vars,
+        node_t* node
+    ) -> node_t*;
+
+    auto and_exists_impl (
+        int32 opId,
+        int32 existsOpId,
+        abstracted_vars& vars,
+        node_t* lhs,
+        node_t* rhs
+    ) -> node_t*;
+
+    auto constrain_impl (
+        int32 opId,
+        std::vector<node_t*>& operands,
+        bool isRestrict,
+        node_t* node,
+        node_t* careSet
+    ) -> node_t*;
+
+    auto unmark_operands (std::vector<node_t*> const& operands, node_t* root)
+        -> void;
+
     template<class F>
     auto transform_impl (
         std::unordered_map<node_t*, node_t*>& memo,
@@ -783,8 +1750,10 @@ private:
 
     template<class ExprNode>
     auto from_expression_tree_impl (
-        std::vector<node_pack<2>>& cache,
-        ExprNode const& exprNode
+        ExprNode const& exprNode,
+        int32 opId,
+        node_t* left,
+        node_t* right
     ) -> node_t*;
 
 protected:
@@ -997,288 +1966,1898 @@ auto diagram_manager<Data, Degree, Domain>::from_vector(R&& vector) -> diagram_t
 }
 
 template<class Data, class Degree, class Domain>
-auto diagram_manager<Data, Degree, Domain>::to_vector(diagram_t const& diagram
-) const -> std::vector<int32>
-{
-    std::vector<int32> vector;
-    vector.reserve(as_usize(nodes_.domain_product(0, this->get_var_count())));
-    this->to_vector_g(diagram, std::back_inserter(vector));
-    return vector;
-}
-
-template<class Data, class Degree, class Domain>
-template<std::output_iterator<teddy::int32> O>
-auto diagram_manager<Data, Degree, Domain>::to_vector_g(
-    diagram_t const& diagram,
-    O out
-) const -> void
+template<std::ranges::random_access_range R>
+auto diagram_manager<Data, Degree, Domain>::from_vector_parallel(
+    R const& vector,
+    int32 const threadCount
+) -> diagram_t
 {
-    if (this->get_var_count() == 0)
+    int32 const varCount = this->get_var_count();
+    if (varCount < 2 || threadCount < 2)
     {
-        assert(diagram.unsafe_get_root()->is_terminal());
-        *out++ = diagram.unsafe_get_root()->get_value();
-        return;
+        return this->from_vector(vector);
     }
 
-    std::vector<int32> vars(as_usize(this->get_var_count()));
-    bool wasLast = false;
-    do
+    // Levels [0, splitLevel) are merged at the end, each combination of
+    // their values defines one sub-cube that is staged separately.
+    // Use more sub-cubes than threads so that the load is balanced.
+    int32 splitLevel = 1;
+    while (splitLevel < varCount - 1
+           && nodes_.domain_product(0, splitLevel) < 4 * threadCount)
     {
-        *out++        = this->evaluate(diagram, vars);
-        bool overflow = true;
-        int32 level   = nodes_.get_leaf_level();
-        while (level > 0 && overflow)
-        {
-            --level;
-            int32 const index = nodes_.get_index(level);
-            ++vars[as_uindex(index)];
-            overflow = vars[as_uindex(index)] == nodes_.get_domain(index);
-            if (overflow)
-            {
-                vars[as_uindex(index)] = 0;
-            }
-
-            wasLast = overflow && 0 == level;
-        }
-    } while (not wasLast);
-}
+        ++splitLevel;
+    }
+    int64 const chunkCount = nodes_.domain_product(0, splitLevel);
+    int64 const chunkSize  = nodes_.domain_product(splitLevel, varCount);
+    assert(
+        static_cast<int64>(std::ranges::size(vector)) == chunkCount * chunkSize
+    );
 
-template<class Data, class Degree, class Domain>
-template<class Foo>
-requires(is_bdd<Degree>)
-auto diagram_manager<Data, Degree, Domain>::from_pla(
-    pla_file const& file,
-    fold_type const foldType
-) -> utils::second_t<Foo, std::vector<diagram_t>>
-{
-    auto const product = [this] (auto const& cube)
+    // Each sub-diagram is staged as records [index, son0, son1, ...]
+    // ordered bottom-up, terminal sons are stored as ~value.
+    std::vector<std::vector<int32>> records(as_usize(chunkCount));
+    std::vector<int32> roots(as_usize(chunkCount));
+    std::atomic<int64> nextChunk = 0;
+    auto const stage_chunks = [&, this] ()
     {
-        std::vector<diagram_t> variables;
-        variables.reserve(cube.size());
-        for (int32 i = 0; i < cube.size(); ++i)
+        std::unordered_multimap<std::size_t, int32> unique;
+        std::vector<int32> stack;
+        for (;;)
         {
-            if (cube.get(i) == 1)
-            {
-                variables.emplace_back(this->variable(i));
-            }
-            else if (cube.get(i) == 0)
+            int64 const chunk = nextChunk.fetch_add(1);
+            if (chunk >= chunkCount)
             {
-                variables.emplace_back(this->variable_not(i));
+                break;
             }
+            unique.clear();
+            roots[as_uindex(chunk)] = this->stage_vector_impl(
+                std::ranges::begin(vector) + chunk * chunkSize,
+                splitLevel,
+                records[as_uindex(chunk)],
+                unique,
+                stack
+            );
         }
-        return this->left_fold<ops::AND>(variables);
     };
 
-    auto const orFold = [this, foldType] (auto& diagrams)
+    std::vector<std::thread> threads;
+    int64 const workerCount = utils::min(int64 {threadCount}, chunkCount);
+    for (int64 i = 1; i < workerCount; ++i)
     {
-        switch (foldType)
-        {
-        case fold_type::Left:
-            return this->left_fold<ops::OR>(diagrams);
+        threads.emplace_back(stage_chunks);
+    }
+    stage_chunks();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
 
-        case fold_type::Tree:
-            return this->tree_fold<ops::OR>(diagrams);
+    // Merge staged sub-diagrams into unique tables.
+    std::vector<node_t*> level(as_usize(chunkCount));
+    std::vector<node_t*> offsetToNode;
+    for (int64 chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        std::vector<int32> const& chunkRecords = records[as_uindex(chunk)];
+        offsetToNode.resize(chunkRecords.size());
+        auto const to_node = [this, &offsetToNode] (int32 const son)
+        {
+            return son < 0 ? nodes_.make_terminal_node(~son)
+                           : offsetToNode[as_uindex(son)];
+        };
 
-        default:
-            assert(false);
-            return this->constant(0);
+        int32 offset = 0;
+        while (offset < ssize(chunkRecords))
+        {
+            int32 const index  = chunkRecords[as_uindex(offset)];
+            int32 const domain = nodes_.get_domain(index);
+            son_container sons = nodes_.make_son_container(domain);
+            for (int32 k = 0; k < domain; ++k)
+            {
+                sons[k] = to_node(chunkRecords[as_uindex(offset + 1 + k)]);
+            }
+            offsetToNode[as_uindex(offset)]
+                = nodes_.make_internal_node(index, sons);
+            offset += 1 + domain;
         }
-    };
 
-    auto const& plaLines      = file.get_lines();
-    int64 const lineCount     = file.get_line_count();
-    int64 const functionCount = file.get_function_count();
+        level[as_uindex(chunk)] = to_node(roots[as_uindex(chunk)]);
+        std::vector<int32>().swap(records[as_uindex(chunk)]);
+    }
 
-    // Create a diagram for each function.
-    std::vector<diagram_t> functionDiagrams;
-    functionDiagrams.reserve(functionCount);
-    for (int32 fi = 0; fi < functionCount; ++fi)
+    // Build the top levels from roots of the sub-diagrams.
+    for (int32 currentLevel = splitLevel - 1; currentLevel >= 0;
+         --currentLevel)
     {
-        // First create a diagram for each product.
-        std::vector<diagram_t> products;
-        // products.reserve(lineCount);
-        for (int32 li = 0; li < lineCount; ++li)
+        int32 const index  = nodes_.get_index(currentLevel);
+        int32 const domain = nodes_.get_domain(index);
+        int64 const count  = ssize(level) / domain;
+        for (int64 i = 0; i < count; ++i)
         {
-            // We are doing SOP so we are only interested
-            // in functions with value 1.
-            if (plaLines[as_usize(li)].fVals_.get(fi) == 1)
+            son_container sons = nodes_.make_son_container(domain);
+            for (int32 k = 0; k < domain; ++k)
             {
-                products.emplace_back(product(plaLines[li].cube_));
+                sons[k] = level[as_uindex(i * domain + k)];
             }
+            level[as_uindex(i)] = nodes_.make_internal_node(index, sons);
         }
-
-        // In this case we just have a constant function.
-        if (products.empty())
-        {
-            products.emplace_back(this->constant(0));
-        }
-
-        // Then merge products using OR.
-        functionDiagrams.emplace_back(orFold(products));
+        level.resize(as_usize(count));
     }
 
-    return functionDiagrams;
+    assert(ssize(level) == 1);
+    nodes_.run_deferred();
+    return diagram_t(level.front());
 }
 
 template<class Data, class Degree, class Domain>
-template<expression_node Node>
-auto diagram_manager<Data, Degree, Domain>::from_expression_tree(
-    Node const& root
-) -> diagram_t
+auto diagram_manager<Data, Degree, Domain>::to_vector(diagram_t const& diagram
+) const -> std::vector<int32>
 {
-    int64 constexpr CacheCapacity = 100'000;
-    std::vector<node_pack<2>> cache(as_usize(CacheCapacity));
-    node_t* newRoot = this->from_expression_tree_impl(cache, root);
-    nodes_.run_deferred();
-    return diagram_t(newRoot);
+    std::vector<int32> vector(
+        as_usize(nodes_.domain_product(0, this->get_var_count()))
+    );
+    this->to_vector_g(diagram, vector.data());
+    return vector;
 }
 
 template<class Data, class Degree, class Domain>
-template<class ExprNode>
-auto diagram_manager<Data, Degree, Domain>::from_expression_tree_impl(
-    std::vector<node_pack<2>>& cache,
-    ExprNode const& exprNode
-) -> node_t*
+template<std::output_iterator<teddy::int32> O>
+auto diagram_manager<Data, Degree, Domain>::to_vector_g(
+    diagram_t const& diagram,
+    O out
+) const -> void
 {
-    if (exprNode.is_constant())
+    node_t* const root = diagram.unsafe_get_root();
+    if constexpr (requires {
+                      requires std::contiguous_iterator<O>;
+                      requires utils::same_as<std::iter_value_t<O>, int32>;
+                  })
     {
-        return nodes_.make_terminal_node(exprNode.get_value());
+        std::unordered_map<node_t*, int32 const*> memo;
+        this->to_vector_impl(root, 0, std::to_address(out), memo);
     }
-
-    if (exprNode.is_variable())
+    else
     {
-        return this->variable_impl(exprNode.get_index());
+        this->to_vector_impl(root, 0, out);
+    }
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::from_pla(
+    pla_file const& file,
+    fold_type const foldType
+) -> utils::second_t<Foo, std::vector<diagram_t>>
+{
+    auto const& plaLines = file.get_lines();
+    return this->sum_of_products_impl(
+        file.get_line_count(),
+        file.get_function_count(),
+        [&plaLines] (int64 const li, int32 const fi)
+        { return plaLines[as_uindex(li)].fVals_.get(fi) == 1; },
+        [this, &plaLines] (int64 const li)
+        {
+            bool_cube const& cube = plaLines[as_uindex(li)].cube_;
+            return this->cube_product_impl(
+                cube.size(),
+                [&cube] (int32 const i) { return cube.get(i); }
+            );
+        },
+        foldType
+    );
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::from_pla(
+    pla_stream& stream,
+    fold_type const foldType
+) -> utils::second_t<Foo, std::optional<std::vector<diagram_t>>>
+{
+    int64 constexpr BlockSize = 4'096;
+    int32 const functionCount = stream.get_function_count();
+    packed_cubes inputs(stream.get_variable_count());
+    packed_cubes outputs(functionCount);
+
+    std::vector<diagram_t> functionDiagrams(
+        as_usize(functionCount),
+        this->constant(0)
+    );
+    for (;;)
+    {
+        std::optional<int64> const lineCount
+            = stream.read_lines(inputs, outputs, BlockSize);
+        if (not lineCount)
+        {
+            return std::nullopt;
+        }
+
+        if (0 == *lineCount)
+        {
+            break;
+        }
+
+        std::vector<diagram_t> const blockDiagrams
+            = this->sum_of_products_impl(
+                *lineCount,
+                functionCount,
+                [&outputs] (int64 const li, int32 const fi)
+                { return outputs.get(li, fi) == 1; },
+                [this, &inputs] (int64 const li)
+                {
+                    return this->cube_product_impl(
+                        inputs.size(),
+                        [&inputs, li] (int32 const i)
+                        { return inputs.get(li, i); }
+                    );
+                },
+                foldType
+            );
+
+        for (int32 fi = 0; fi < functionCount; ++fi)
+        {
+            functionDiagrams[as_uindex(fi)] = this->apply<ops::OR>(
+                functionDiagrams[as_uindex(fi)],
+                blockDiagrams[as_uindex(fi)]
+            );
+        }
+    }
+
+    return std::optional<std::vector<diagram_t>>(
+        static_cast<std::vector<diagram_t>&&>(functionDiagrams)
+    );
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::from_pla_parallel(
+    pla_file const& file,
+    int32 const threadCount,
+    fold_type const foldType
+) -> utils::second_t<Foo, std::vector<diagram_t>>
+{
+    int32 const functionCount = file.get_function_count();
+    int32 const workerCount   = utils::min(threadCount, functionCount);
+    if (workerCount < 2)
+    {
+        return this->from_pla(file, foldType);
+    }
+
+    // Each worker owns a manager and diagrams of functions it has built.
+    // Diagrams are declared after managers so they are destroyed first.
+    std::vector<diagram_manager> workers;
+    workers.reserve(as_usize(workerCount));
+    for (int32 i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(this->make_worker_impl());
+    }
+    std::vector<std::vector<int32>> workerFunctions(as_usize(workerCount));
+    std::vector<std::vector<diagram_t>> workerDiagrams(as_usize(workerCount));
+
+    std::atomic<int32> nextFunction = 0;
+    auto const build_functions      = [&] (int32 const workerId)
+    {
+        diagram_manager& worker  = workers[as_uindex(workerId)];
+        auto const& plaLines     = file.get_lines();
+        int64 const lineCount    = file.get_line_count();
+        std::vector<diagram_t> cubeDiagrams;
+        cubeDiagrams.reserve(as_usize(lineCount));
+        for (int64 li = 0; li < lineCount; ++li)
+        {
+            bool_cube const& cube = plaLines[as_uindex(li)].cube_;
+            cubeDiagrams.emplace_back(worker.cube_product_impl(
+                cube.size(),
+                [&cube] (int32 const i) { return cube.get(i); }
+            ));
+        }
+
+        std::vector<diagram_t> products;
+        for (;;)
+        {
+            int32 const fi = nextFunction.fetch_add(1);
+            if (fi >= functionCount)
+            {
+                break;
+            }
+
+            products.clear();
+            for (int64 li = 0; li < lineCount; ++li)
+            {
+                if (plaLines[as_uindex(li)].fVals_.get(fi) == 1)
+                {
+                    products.push_back(cubeDiagrams[as_uindex(li)]);
+                }
+            }
+
+            if (products.empty())
+            {
+                products.emplace_back(worker.constant(0));
+            }
+
+            workerFunctions[as_uindex(workerId)].push_back(fi);
+            workerDiagrams[as_uindex(workerId)].emplace_back(
+                worker.template fold<ops::OR>(products, foldType)
+            );
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int32 i = 1; i < workerCount; ++i)
+    {
+        threads.emplace_back(build_functions, i);
+    }
+    build_functions(0);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Transfer results, nodes shared by functions of one worker
+    // are transferred only once.
+    std::vector<diagram_t> functionDiagrams(
+        as_usize(functionCount),
+        this->constant(0)
+    );
+    for (int32 w = 0; w < workerCount; ++w)
+    {
+        std::unordered_map<node_t*, node_t*> memo;
+        std::vector<int32> const& functions = workerFunctions[as_uindex(w)];
+        for (int64 i = 0; i < ssize(functions); ++i)
+        {
+            node_t* const root = this->transfer_impl(
+                workerDiagrams[as_uindex(w)][as_uindex(i)].unsafe_get_root(),
+                memo
+            );
+            nodes_.run_deferred();
+            functionDiagrams[as_uindex(functions[as_uindex(i)])]
+                = diagram_t(root);
+        }
+    }
+
+    return functionDiagrams;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::transfer(
+    [[maybe_unused]] diagram_manager const& source,
+    diagram_t const& diagram
+) -> diagram_t
+{
+    assert(source.get_order() == this->get_order());
+    assert(source.get_domains() == this->get_domains());
+    std::unordered_map<node_t*, node_t*> memo;
+    node_t* const root = this->transfer_impl(diagram.unsafe_get_root(), memo);
+    nodes_.run_deferred();
+    return diagram_t(root);
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::from_dddmp(
+    dddmp_file const& file,
+    std::vector<int32> const& varIds
+) -> utils::second_t<Foo, std::optional<std::vector<diagram_t>>>
+{
+    int32 const varCount = this->get_var_count();
+
+    // DDDMP id -> index.
+    std::unordered_map<int32, int32> idToIndex;
+    for (int32 index = 0; index < varCount; ++index)
+    {
+        idToIndex.emplace(
+            varIds.empty() ? index : varIds[as_uindex(index)],
+            index
+        );
+    }
+
+    // Index of each node, leaves have -1.
+    std::vector<dddmp_file::dddmp_node> const& nodes = file.get_nodes();
+    std::vector<int32> indices(nodes.size(), -1);
+    for (int64 i = 0; i < ssize(nodes); ++i)
+    {
+        dddmp_file::dddmp_node const& node = nodes[as_uindex(i)];
+        if (node.then_ == 0)
+        {
+            if (node.var_ != 0 && node.var_ != 1)
+            {
+                return std::nullopt;
+            }
+            continue;
+        }
+
+        auto const indexIt = idToIndex.find(node.var_);
+        if (indexIt == idToIndex.end())
+        {
+            return std::nullopt;
+        }
+        indices[as_uindex(i)] = indexIt->second;
+    }
+
+    // Nodes can be created directly if sons are below their parents.
+    bool isOrdered = true;
+    for (int64 i = 0; i < ssize(nodes) && isOrdered; ++i)
+    {
+        dddmp_file::dddmp_node const& node = nodes[as_uindex(i)];
+        if (node.then_ == 0)
+        {
+            continue;
+        }
+
+        int32 const level = nodes_.get_level(indices[as_uindex(i)]);
+        for (int32 const sonId : {node.then_, node.else_})
+        {
+            int32 const sonIndex
+                = indices[as_uindex((sonId < 0 ? -sonId : sonId) - 1)];
+            isOrdered = isOrdered
+                     && (sonIndex == -1 || nodes_.get_level(sonIndex) > level);
+        }
+    }
+
+    std::vector<diagram_t> diagrams;
+    diagrams.reserve(file.get_root_ids().size());
+    if (isOrdered)
+    {
+        // Each node can be used both as regular and as complemented.
+        std::vector<node_t*> memo(2 * nodes.size() + 2, nullptr);
+        std::vector<node_t*> roots;
+        for (int32 const rootId : file.get_root_ids())
+        {
+            roots.push_back(
+                this->from_dddmp_impl(nodes, indices, memo, rootId)
+            );
+        }
+        nodes_.run_deferred();
+        for (node_t* const root : roots)
+        {
+            diagrams.emplace_back(root);
+        }
+    }
+    else
+    {
+        std::vector<diagram_t> memo(2 * nodes.size() + 2);
+        for (int32 const rootId : file.get_root_ids())
+        {
+            diagrams.push_back(
+                this->from_dddmp_apply_impl(nodes, indices, memo, rootId)
+            );
+        }
+    }
+
+    return std::optional<std::vector<diagram_t>>(
+        static_cast<std::vector<diagram_t>&&>(diagrams)
+    );
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::from_dddmp_impl(
+    std::vector<dddmp_file::dddmp_node> const& nodes,
+    std::vector<int32> const& indices,
+    std::vector<node_t*>& memo,
+    int32 const id
+) -> node_t*
+{
+    bool const isComplement = id < 0;
+    int32 const regularId   = isComplement ? -id : id;
+    node_t*& memoNode = memo[as_uindex(2 * regularId + (isComplement ? 1 : 0))];
+    if (memoNode)
+    {
+        return memoNode;
+    }
+
+    dddmp_file::dddmp_node const& node = nodes[as_uindex(regularId - 1)];
+    if (node.then_ == 0)
+    {
+        memoNode = nodes_.make_terminal_node(
+            isComplement ? 1 - node.var_ : node.var_
+        );
+        return memoNode;
+    }
+
+    // Complement is pushed down to the sons.
+    int32 const sign   = isComplement ? -1 : 1;
+    son_container sons = nodes_.make_son_container(2);
+    sons[0] = this->from_dddmp_impl(nodes, indices, memo, sign * node.else_);
+    sons[1] = this->from_dddmp_impl(nodes, indices, memo, sign * node.then_);
+    memoNode = nodes_.make_internal_node(
+        indices[as_uindex(regularId - 1)],
+        sons
+    );
+    return memoNode;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::from_dddmp_apply_impl(
+    std::vector<dddmp_file::dddmp_node> const& nodes,
+    std::vector<int32> const& indices,
+    std::vector<diagram_t>& memo,
+    int32 const id
+) -> diagram_t
+{
+    bool const isComplement = id < 0;
+    int32 const regularId   = isComplement ? -id : id;
+    diagram_t& memoDiagram
+        = memo[as_uindex(2 * regularId + (isComplement ? 1 : 0))];
+    if (memoDiagram.unsafe_get_root())
+    {
+        return memoDiagram;
+    }
+
+    dddmp_file::dddmp_node const& node = nodes[as_uindex(regularId - 1)];
+    if (node.then_ == 0)
+    {
+        memoDiagram = this->constant(isComplement ? 1 - node.var_ : node.var_);
+    }
+    else if (isComplement)
+    {
+        memoDiagram = this->negate(
+            this->from_dddmp_apply_impl(nodes, indices, memo, regularId)
+        );
+    }
+    else
+    {
+        int32 const index = indices[as_uindex(regularId - 1)];
+        diagram_t const thenDiagram
+            = this->from_dddmp_apply_impl(nodes, indices, memo, node.then_);
+        diagram_t const elseDiagram
+            = this->from_dddmp_apply_impl(nodes, indices, memo, node.else_);
+        memoDiagram = this->template apply<ops::OR>(
+            this->template apply<ops::AND>(this->variable(index), thenDiagram),
+            this->template apply<ops::AND>(
+                this->variable_not(index),
+                elseDiagram
+            )
+        );
+    }
+    return memoDiagram;
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::to_dddmp(
+    std::ostream& out,
+    std::vector<diagram_t> const& diagrams,
+    std::vector<int32> const& varIds,
+    dddmp_mode const mode
+) const -> utils::second_t<Foo, void>
+{
+    struct key_hash
+    {
+        auto operator() (std::array<int32, 3> const& key) const -> std::size_t
+        {
+            return utils::pack_hash(key[0], key[1], key[2]);
+        }
+    };
+
+    int32 const varCount = this->get_var_count();
+    auto const get_id    = [&varIds] (int32 const index)
+    { return varIds.empty() ? index : varIds[as_uindex(index)]; };
+
+    // Node 1 is the only leaf (constant 1), 0 is its complement.
+    // Then-edges are kept regular by complementing the whole node.
+    std::vector<dddmp_file::dddmp_node> lines {{1, 0, 0}};
+    std::unordered_map<std::array<int32, 3>, int32, key_hash> unique;
+    std::unordered_map<node_t*, int32> ids;
+    std::vector<int32> rootIds;
+    for (diagram_t const& diagram : diagrams)
+    {
+        nodes_.traverse_post(
+            diagram.unsafe_get_root(),
+            [&] (node_t* const node)
+            {
+                if (ids.contains(node))
+                {
+                    return;
+                }
+
+                if (node->is_terminal())
+                {
+                    assert(node->get_value() == 0 || node->get_value() == 1);
+                    ids.emplace(node, node->get_value() == 1 ? 1 : -1);
+                    return;
+                }
+
+                int32 thenId            = ids[node->get_son(1)];
+                int32 elseId            = ids[node->get_son(0)];
+                bool const isComplement = thenId < 0;
+                if (isComplement)
+                {
+                    thenId = -thenId;
+                    elseId = -elseId;
+                }
+                int32 const varId = get_id(node->get_index());
+                auto const [lineIt, isNew] = unique.try_emplace(
+                    std::array<int32, 3> {varId, thenId, elseId},
+                    static_cast<int32>(ssize(lines) + 1)
+                );
+                if (isNew)
+                {
+                    lines.push_back({varId, thenId, elseId});
+                }
+                ids.emplace(
+                    node,
+                    isComplement ? -lineIt->second : lineIt->second
+                );
+            }
+        );
+        rootIds.push_back(ids[diagram.unsafe_get_root()]);
+    }
+
+    // Support variables, sorted by ids. Nodes refer to the positions.
+    std::vector<int32> suppIndices;
+    std::vector<bool> isInSupport(as_usize(varCount), false);
+    std::unordered_map<int32, int32> idToIndex;
+    int32 idCount = 0;
+    for (int32 index = 0; index < varCount; ++index)
+    {
+        idToIndex.emplace(get_id(index), index);
+        idCount = utils::max(idCount, get_id(index) + 1);
+    }
+    for (int64 i = 1; i < ssize(lines); ++i)
+    {
+        int32 const index = idToIndex[lines[as_uindex(i)].var_];
+        if (not isInSupport[as_uindex(index)])
+        {
+            isInSupport[as_uindex(index)] = true;
+            suppIndices.push_back(index);
+        }
+    }
+    utils::sort(
+        suppIndices,
+        [&get_id] (int32 const l, int32 const r)
+        { return get_id(l) < get_id(r); }
+    );
+    std::unordered_map<int32, int32> idToSuppPos;
+    for (int64 i = 0; i < ssize(suppIndices); ++i)
+    {
+        idToSuppPos.emplace(
+            get_id(suppIndices[as_uindex(i)]),
+            static_cast<int32>(i)
+        );
+    }
+
+    out << ".ver DDDMP-2.0\n"
+        << ".mode " << (mode == dddmp_mode::Binary ? "B" : "A") << "\n"
+        << ".varinfo 0\n"
+        << ".nnodes " << ssize(lines) << "\n"
+        << ".nvars " << idCount << "\n"
+        << ".nsuppvars " << ssize(suppIndices) << "\n"
+        << ".ids";
+    for (int32 const index : suppIndices)
+    {
+        out << " " << get_id(index);
+    }
+    out << "\n.permids";
+    for (int32 const index : suppIndices)
+    {
+        out << " " << nodes_.get_level(index);
+    }
+    out << "\n.nroots " << ssize(rootIds) << "\n.rootids";
+    for (int32 const rootId : rootIds)
+    {
+        out << " " << rootId;
+    }
+    out << "\n.nodes\n";
+    if (mode == dddmp_mode::Binary)
+    {
+        std::vector<int32> positions {static_cast<int32>(ssize(suppIndices))};
+        for (int64 i = 1; i < ssize(lines); ++i)
+        {
+            positions.push_back(idToSuppPos[lines[as_uindex(i)].var_]);
+        }
+        dddmp_file::write_binary_nodes(
+            out,
+            lines,
+            positions,
+            static_cast<int32>(ssize(suppIndices))
+        );
+    }
+    else
+    {
+        out << "1 T 1 0 0\n";
+        for (int64 i = 1; i < ssize(lines); ++i)
+        {
+            dddmp_file::dddmp_node const& line = lines[as_uindex(i)];
+            out << (i + 1) << " " << line.var_ << " "
+                << idToSuppPos[line.var_] << " " << line.then_ << " "
+                << line.else_ << "\n";
+        }
+    }
+    out << ".end\n";
+}
+
+template<class Data, class Degree, class Domain>
+template<class GetValue>
+auto diagram_manager<Data, Degree, Domain>::cube_product_impl(
+    int32 const size,
+    GetValue getValue
+) -> diagram_t
+{
+    // The product is a single chain, it is built bottom-up directly
+    // without creating diagrams for the literals. Terminal 0 is only
+    // created if there is a literal, otherwise it would stay marked.
+    node_t* zero = nullptr;
+    node_t* node = nodes_.make_terminal_node(1);
+    for (int32 level = this->get_var_count() - 1; level >= 0; --level)
+    {
+        int32 const index = nodes_.get_index(level);
+        if (index >= size)
+        {
+            continue;
+        }
+
+        int32 const value = getValue(index);
+        if (value == 0 || value == 1)
+        {
+            zero = zero ? zero : nodes_.make_terminal_node(0);
+            son_container sons = nodes_.make_son_container(2);
+            sons[value]        = node;
+            sons[1 - value]    = zero;
+            node               = nodes_.make_internal_node(index, sons);
+        }
+    }
+
+    nodes_.run_deferred();
+    return diagram_t(node);
+}
+
+template<class Data, class Degree, class Domain>
+template<class IsInFunction, class MakeProduct>
+auto diagram_manager<Data, Degree, Domain>::sum_of_products_impl(
+    int64 const lineCount,
+    int32 const functionCount,
+    IsInFunction isInFunction,
+    MakeProduct makeProduct,
+    fold_type const foldType
+) -> std::vector<diagram_t>
+{
+    // Lines are grouped by their output part. Products of a group are
+    // merged once and the sum is shared by all functions of the group.
+    std::unordered_map<std::string, int64> groupIds;
+    std::vector<std::string> groupKeys;
+    std::vector<std::vector<diagram_t>> groupProducts;
+    std::string key;
+    for (int64 li = 0; li < lineCount; ++li)
+    {
+        // We are doing SOP so we are only interested
+        // in functions with value 1.
+        key.assign(as_usize(functionCount), '0');
+        bool isUsed = false;
+        for (int32 fi = 0; fi < functionCount; ++fi)
+        {
+            if (isInFunction(li, fi))
+            {
+                key[as_uindex(fi)] = '1';
+                isUsed             = true;
+            }
+        }
+
+        if (not isUsed)
+        {
+            continue;
+        }
+
+        auto const [groupIt, isNew]
+            = groupIds.try_emplace(key, ssize(groupKeys));
+        if (isNew)
+        {
+            groupKeys.push_back(key);
+            groupProducts.emplace_back();
+        }
+        groupProducts[as_uindex(groupIt->second)].push_back(makeProduct(li));
+    }
+
+    std::vector<diagram_t> groupSums;
+    groupSums.reserve(groupProducts.size());
+    for (std::vector<diagram_t>& products : groupProducts)
+    {
+        groupSums.push_back(this->fold<ops::OR>(products, foldType));
+    }
+
+    std::vector<diagram_t> functionDiagrams;
+    functionDiagrams.reserve(as_usize(functionCount));
+    std::vector<diagram_t> sums;
+    for (int32 fi = 0; fi < functionCount; ++fi)
+    {
+        sums.clear();
+        for (int64 gi = 0; gi < ssize(groupKeys); ++gi)
+        {
+            if (groupKeys[as_uindex(gi)][as_uindex(fi)] == '1')
+            {
+                sums.push_back(groupSums[as_uindex(gi)]);
+            }
+        }
+
+        // In this case we just have a constant function.
+        if (sums.empty())
+        {
+            sums.emplace_back(this->constant(0));
+        }
+
+        functionDiagrams.emplace_back(this->fold<ops::OR>(sums, foldType));
+    }
+
+    return functionDiagrams;
+}
+
+template<class Data, class Degree, class Domain>
+template<expression_node Node>
+auto diagram_manager<Data, Degree, Domain>::from_expression_tree(
+    Node const& root
+) -> diagram_t
+{
+    // Post-order traversal with memoization of already built nodes.
+    std::unordered_map<Node const*, node_t*> memo;
+    std::unordered_map<int32, int32> opIds;
+    std::vector<Node const*> stack {&root};
+    while (not stack.empty())
+    {
+        Node const* const exprNode = stack.back();
+        if (memo.contains(exprNode))
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        if (exprNode->is_constant())
+        {
+            memo.emplace(
+                exprNode,
+                nodes_.make_terminal_node(exprNode->get_value())
+            );
+            stack.pop_back();
+            continue;
+        }
+
+        if (exprNode->is_variable())
+        {
+            memo.emplace(exprNode, this->variable_impl(exprNode->get_index()));
+            stack.pop_back();
+            continue;
+        }
+
+        assert(exprNode->is_operation());
+
+        Node const* const leftExpr  = &exprNode->get_left();
+        Node const* const rightExpr = &exprNode->get_right();
+        auto const leftIt           = memo.find(leftExpr);
+        auto const rightIt          = memo.find(rightExpr);
+        if (leftIt != memo.end() && rightIt != memo.end())
+        {
+            // The operation is only known at runtime. New id ensures that
+            // results of other operations are not mistaken for its results.
+            int32 opId = 0;
+            if constexpr (has_operation_id<Node>)
+            {
+                auto const [opIt, isNew]
+                    = opIds.try_emplace(exprNode->get_operation_id(), 0);
+                if (isNew)
+                {
+                    opIt->second = nodes_.make_operation_id();
+                }
+                opId = opIt->second;
+            }
+            else
+            {
+                opId = nodes_.make_operation_id();
+            }
+
+            node_t* const result = this->from_expression_tree_impl(
+                *exprNode,
+                opId,
+                leftIt->second,
+                rightIt->second
+            );
+            memo.emplace(exprNode, result);
+            stack.pop_back();
+            continue;
+        }
+
+        if (rightIt == memo.end())
+        {
+            stack.push_back(rightExpr);
+        }
+
+        if (leftIt == memo.end())
+        {
+            stack.push_back(leftExpr);
+        }
+    }
+
+    node_t* const newRoot = memo.find(&root)->second;
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
+
+template<class Data, class Degree, class Domain>
+template<class ExprNode>
+auto diagram_manager<Data, Degree, Domain>::from_expression_tree_impl(
+    ExprNode const& exprNode,
+    int32 const opId,
+    node_t* const left,
+    node_t* const right
+) -> node_t*
+{
+    auto const operation = [&exprNode] (auto const lhs, auto const rhs)
+    {
+        if (lhs == Nondetermined || rhs == Nondetermined)
+        {
+            return Nondetermined;
+        }
+        return static_cast<int32>(exprNode.evaluate(lhs, rhs));
+    };
+
+    return this->apply_dynamic_impl(opId, false, operation, left, right);
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::variable_impl(int32 const index)
+    -> node_t*
+{
+    int32 const varDomain = nodes_.get_domain(index);
+    son_container sons    = nodes_.make_son_container(varDomain);
+    for (int32 val = 0; val < varDomain; ++val)
+    {
+        sons[val] = nodes_.make_terminal_node(val);
+    }
+    return nodes_.make_internal_node(index, sons);
+}
+
+template<class Data, class Degree, class Domain>
+template<teddy_bin_op Op>
+auto diagram_manager<Data, Degree, Domain>::apply(
+    diagram_t const& lhs,
+    diagram_t const& rhs
+) -> diagram_t
+{
+    /*
+     * Use bounded MAX if the max value is known.
+     * This should perform better since it can short-circuit.
+     */
+    using OpType = utils::type_if<
+        utils::is_same<Op, ops::MAX>::value && domains::is_fixed<Domain>::value,
+        ops::MAXB<Domain::value>,
+        Op>::type;
+
+    node_t* const newRoot = this->apply_impl(
+        OpType(),
+        lhs.unsafe_get_root(),
+        rhs.unsafe_get_root()
+    );
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
+
+template<class Data, class Degree, class Domain>
+template<class Op>
+auto diagram_manager<Data, Degree, Domain>::apply_impl(
+    Op operation,
+    node_t* const lhs,
+    node_t* const rhs
+) -> node_t*
+{
+#ifdef LIBTEDDY_COLLECT_STATS
+    ++stats::get_stats().applyStepCalls_;
+#endif
+
+    node_t* const cached = nodes_.template cache_find<Op>(lhs, rhs);
+    if (cached)
+    {
+        return cached;
+    }
+
+    int32 const lhsVal = lhs->is_terminal() ? lhs->get_value() : Nondetermined;
+    int32 const rhsVal = rhs->is_terminal() ? rhs->get_value() : Nondetermined;
+    int32 const opVal  = operation(lhsVal, rhsVal);
+
+    if (opVal != Nondetermined)
+    {
+        node_t* const result = nodes_.make_terminal_node(opVal);
+        nodes_.template cache_put<Op>(result, lhs, rhs);
+        return result;
+    }
+
+    int32 const lhsLevel = nodes_.get_level(lhs);
+    int32 const rhsLevel = nodes_.get_level(rhs);
+    int32 const topLevel = utils::min(lhsLevel, rhsLevel);
+    int32 const topIndex = nodes_.get_index(topLevel);
+    int32 const domain   = nodes_.get_domain(topIndex);
+    son_container sons   = nodes_.make_son_container(domain);
+    for (int32 k = 0; k < domain; ++k)
+    {
+        sons[k] = this->apply_impl(
+            operation,
+            lhsLevel == topLevel ? lhs->get_son(k) : lhs,
+            rhsLevel == topLevel ? rhs->get_son(k) : rhs
+        );
+    }
+
+    node_t* const result = nodes_.make_internal_node(topIndex, sons);
+    nodes_.template cache_put<Op>(result, lhs, rhs);
+    return result;
+}
+
+template<class Data, class Degree, class Domain>
+template<class F>
+auto diagram_manager<Data, Degree, Domain>::register_operation(
+    F function,
+    bool const isCommutative
+) -> registered_operation<F>
+{
+    return registered_operation<F>(
+        nodes_.make_persistent_operation_id(),
+        isCommutative,
+        static_cast<F&&>(function)
+    );
+}
+
+template<class Data, class Degree, class Domain>
+template<class F>
+auto diagram_manager<Data, Degree, Domain>::apply(
+    registered_operation<F> const& operation,
+    diagram_t const& lhs,
+    diagram_t const& rhs
+) -> diagram_t
+{
+    node_t* const newRoot = this->apply_dynamic_impl(
+        operation.get_id(),
+        operation.is_commutative(),
+        operation,
+        lhs.unsafe_get_root(),
+        rhs.unsafe_get_root()
+    );
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
+
+template<class Data, class Degree, class Domain>
+template<class Op>
+auto diagram_manager<Data, Degree, Domain>::apply_dynamic_impl(
+    int32 const opId,
+    bool const isCommutative,
+    Op const& operation,
+    node_t* lhs,
+    node_t* rhs
+) -> node_t*
+{
+    if (isCommutative && rhs < lhs)
+    {
+        utils::swap(lhs, rhs);
+    }
+
+    node_t* const cached = nodes_.cache_find(opId, lhs, rhs);
+    if (cached)
+    {
+        return cached;
+    }
+
+    int32 const lhsVal = lhs->is_terminal() ? lhs->get_value() : Nondetermined;
+    int32 const rhsVal = rhs->is_terminal() ? rhs->get_value() : Nondetermined;
+    int32 const opVal  = operation(lhsVal, rhsVal);
+
+    if (opVal != Nondetermined)
+    {
+        node_t* const result = nodes_.make_terminal_node(opVal);
+        nodes_.cache_put(opId, result, lhs, rhs);
+        return result;
+    }
+
+    int32 const lhsLevel = nodes_.get_level(lhs);
+    int32 const rhsLevel = nodes_.get_level(rhs);
+    int32 const topLevel = utils::min(lhsLevel, rhsLevel);
+    int32 const topIndex = nodes_.get_index(topLevel);
+    int32 const domain   = nodes_.get_domain(topIndex);
+    son_container sons   = nodes_.make_son_container(domain);
+    for (int32 k = 0; k < domain; ++k)
+    {
+        sons[k] = this->apply_dynamic_impl(
+            opId,
+            isCommutative,
+            operation,
+            lhsLevel == topLevel ? lhs->get_son(k) : lhs,
+            rhsLevel == topLevel ? rhs->get_son(k) : rhs
+        );
+    }
+
+    node_t* const result = nodes_.make_internal_node(topIndex, sons);
+    nodes_.cache_put(opId, result, lhs, rhs);
+    return result;
+}
+
+template<class Data, class Degree, class Domain>
+template<teddy_bin_op Op, class... Diagram>
+auto diagram_manager<Data, Degree, Domain>::apply_n(Diagram const&... diagram)
+    -> diagram_t
+    requires(utils::same_as<Diagram, diagram_t> && ...)
+{
+    /*
+     * Use bounded MAX if the max value is known.
+     * This should perform better since it can short-circuit.
+     */
+    using OpType = utils::type_if<
+        utils::is_same<Op, ops::MAX>::value && domains::is_fixed<Domain>::value,
+        ops::MAXB<Domain::value>,
+        Op>::type;
+
+    if constexpr (sizeof...(Diagram) == 2)
+    {
+        // Binary apply shares the persistent cache of the manager.
+        return this->template apply<Op>(diagram...);
+    }
+    else
+    {
+        // Node count of the manager bounds the node count of each
+        // operand and, unlike counting the operands, costs nothing.
+        int64 const capacity = utils::min(
+            utils::max(nodes_.get_node_count(), int64(100'000)),
+            apply_n_max_capacity(static_cast<int64>(sizeof...(Diagram)))
+        );
+        std::vector<node_pack<sizeof...(Diagram)>> cache(as_usize(capacity));
+        node_t* const newRoot = this->apply_n_impl(
+            cache,
+            OpType(),
+            diagram.unsafe_get_root()...
+        );
+        nodes_.run_deferred();
+        return diagram_t(newRoot);
+    }
+}
+
+template<class Data, class Degree, class Domain>
+template<teddy_bin_op Op>
+auto diagram_manager<Data, Degree, Domain>::apply_n(
+    std::span<diagram_t const> const diagrams
+) -> diagram_t
+{
+    assert(not diagrams.empty());
+
+    using OpType = utils::type_if<
+        utils::is_same<Op, ops::MAX>::value && domains::is_fixed<Domain>::value,
+        ops::MAXB<Domain::value>,
+        Op>::type;
+
+    // The cache grows as needed, so its initial size is derived from
+    // the node count of the manager instead of counting the operands.
+    int64 const arity     = ssize(diagrams);
+    node_span_cache cache = make_node_span_cache(
+        arity,
+        utils::min(nodes_.get_node_count(), int64(100'000))
+    );
+
+    // Nodes of each recursive call are stored on the stack. Its size
+    // is bounded by the depth of the recursion so it never reallocates.
+    std::vector<node_t*> stack;
+    stack.reserve(as_usize(arity * (this->get_var_count() + 2)));
+    for (diagram_t const& diagram : diagrams)
+    {
+        stack.push_back(diagram.unsafe_get_root());
+    }
+
+    node_t* const newRoot = this->apply_n_impl(cache, stack, OpType(), 0);
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::apply_n_max_capacity(
+    int64 const arity
+) -> int64
+{
+    // Bounds the size of the cache to 32 MiB (with 8-byte pointers).
+    int64 constexpr MaxCacheSize = int64(1) << 22;
+    return utils::max(int64(1), MaxCacheSize / (arity + 1));
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::make_node_span_cache(
+    int64 const arity,
+    int64 const nodeCount
+) -> node_span_cache
+{
+    int64 const maxCapacity = apply_n_max_capacity(arity);
+    node_span_cache cache {
+        arity,
+        utils::max(int64(1), utils::min(nodeCount, maxCapacity)),
+        maxCapacity,
+        0,
+        {}
+    };
+    cache.entries_.resize(as_usize(cache.capacity_ * (arity + 1)), nullptr);
+    return cache;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::apply_n_cache_hash(
+    node_t* const* const keys,
+    int64 const arity
+) -> std::size_t
+{
+    std::size_t hash = 0;
+    for (int64 i = 0; i < arity; ++i)
+    {
+        utils::add_hash(hash, keys[i]);
+    }
+    return hash;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::apply_n_cache_find(
+    node_span_cache const& cache,
+    node_t* const* const keys,
+    std::size_t const hash
+) -> node_t*
+{
+    int64 const arity = cache.arity_;
+    int64 const entryIndex
+        = static_cast<int64>(hash % as_usize(cache.capacity_));
+    node_t* const* const entry
+        = cache.entries_.data() + entryIndex * (arity + 1);
+    for (int64 i = 0; i < arity; ++i)
+    {
+        if (entry[i] != keys[i])
+        {
+            return nullptr;
+        }
+    }
+    return entry[arity];
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::apply_n_cache_put(
+    node_span_cache& cache,
+    node_t* const* const keys,
+    std::size_t const hash,
+    node_t* const result
+) -> void
+{
+    int64 const arity     = cache.arity_;
+    int64 const entrySize = arity + 1;
+
+    // Grows the cache and moves all entries to their new positions.
+    if (cache.putCount_ >= cache.capacity_
+        && cache.capacity_ < cache.maxCapacity_)
+    {
+        std::vector<node_t*> oldEntries
+            = static_cast<std::vector<node_t*>&&>(cache.entries_);
+        int64 const oldCapacity = cache.capacity_;
+        cache.capacity_ = utils::min(2 * oldCapacity, cache.maxCapacity_);
+        cache.putCount_ = 0;
+        cache.entries_.assign(as_usize(cache.capacity_ * entrySize), nullptr);
+        for (int64 i = 0; i < oldCapacity; ++i)
+        {
+            node_t* const* const oldEntry = oldEntries.data() + i * entrySize;
+            if (oldEntry[arity])
+            {
+                apply_n_cache_put(
+                    cache,
+                    oldEntry,
+                    apply_n_cache_hash(oldEntry, arity),
+                    oldEntry[arity]
+                );
+            }
+        }
+    }
+
+    int64 const entryIndex
+        = static_cast<int64>(hash % as_usize(cache.capacity_));
+    node_t** const entry = cache.entries_.data() + entryIndex * entrySize;
+    for (int64 i = 0; i < arity; ++i)
+    {
+        entry[i] = keys[i];
+    }
+    entry[arity] = result;
+    ++cache.putCount_;
+}
+
+template<class Data, class Degree, class Domain>
+template<class Op>
+auto diagram_manager<Data, Degree, Domain>::apply_n_impl(
+    node_span_cache& cache,
+    std::vector<node_t*>& stack,
+    Op operation,
+    int64 const offset
+) -> node_t*
+{
+    int64 const arity = cache.arity_;
+
+    // Terminal short-circuit. If the value stays determined after
+    // a nondetermined operand, it does not depend on the other operands.
+    bool isNondetermined = false;
+    int32 opVal          = Nondetermined;
+    for (int64 i = 0; i < arity; ++i)
+    {
+        node_t* const node = stack[as_uindex(offset + i)];
+        int32 const value
+            = node->is_terminal() ? node->get_value() : Nondetermined;
+        isNondetermined = isNondetermined || value == Nondetermined;
+        opVal = i == 0 ? value : operation(opVal, value);
+        if (isNondetermined && opVal != Nondetermined)
+        {
+            break;
+        }
+    }
+
+    if (opVal != Nondetermined)
+    {
+        return nodes_.make_terminal_node(opVal);
+    }
+
+    std::size_t const hash
+        = apply_n_cache_hash(stack.data() + offset, arity);
+    node_t* const cached
+        = apply_n_cache_find(cache, stack.data() + offset, hash);
+    if (cached)
+    {
+        return cached;
+    }
+
+    int32 minLevel = nodes_.get_leaf_level();
+    for (int64 i = 0; i < arity; ++i)
+    {
+        minLevel = utils::min(
+            minLevel,
+            nodes_.get_level(stack[as_uindex(offset + i)])
+        );
+    }
+
+    int32 const topIndex  = nodes_.get_index(minLevel);
+    int32 const domain    = nodes_.get_domain(topIndex);
+    son_container sons    = nodes_.make_son_container(domain);
+    int64 const sonOffset = ssize(stack);
+    for (int32 k = 0; k < domain; ++k)
+    {
+        for (int64 i = 0; i < arity; ++i)
+        {
+            node_t* const node = stack[as_uindex(offset + i)];
+            stack.push_back(
+                nodes_.get_level(node) == minLevel ? node->get_son(k) : node
+            );
+        }
+        sons[k] = this->apply_n_impl(cache, stack, operation, sonOffset);
+        stack.resize(as_usize(sonOffset));
+    }
+
+    node_t* const result = nodes_.make_internal_node(topIndex, sons);
+    apply_n_cache_put(cache, stack.data() + offset, hash, result);
+    return result;
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::ite(
+    diagram_t const& f,
+    diagram_t const& g,
+    diagram_t const& h
+) -> utils::second_t<Foo, diagram_t>
+{
+    int64 const nodeCount = this->get_node_count(f)
+                          + this->get_node_count(g)
+                          + this->get_node_count(h);
+    node_span_cache cache = make_node_span_cache(3, nodeCount);
+    node_t* const zero    = nodes_.make_terminal_node(0);
+    node_t* const one     = nodes_.make_terminal_node(1);
+    node_t* const newRoot = this->ite_impl(
+        cache,
+        zero,
+        one,
+        f.unsafe_get_root(),
+        g.unsafe_get_root(),
+        h.unsafe_get_root()
+    );
+
+    // Terminals might not be used in the result. The root must stay
+    // marked until the diagram references it.
+    if (zero != newRoot)
+    {
+        id_set_notmarked(zero);
+    }
+
+    if (one != newRoot)
+    {
+        id_set_notmarked(one);
+    }
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::ite_impl(
+    node_span_cache& cache,
+    node_t* const zero,
+    node_t* const one,
+    node_t* f,
+    node_t* g,
+    node_t* h
+) -> node_t*
+{
+    // Terminal cases.
+    if (f->is_terminal())
+    {
+        return f->get_value() == 1 ? g : h;
     }
 
-    assert(exprNode.is_operation());
+    if (g == f)
+    {
+        g = one;
+    }
 
-    node_t* const left
-        = this->from_expression_tree_impl(cache, exprNode.get_left());
-    node_t* const right
-        = this->from_expression_tree_impl(cache, exprNode.get_right());
-    auto const operation = [&exprNode] (auto const lhs, auto const rhs)
+    if (h == f)
     {
-        if (lhs == Nondetermined || rhs == Nondetermined)
-        {
-            return Nondetermined;
-        }
-        return static_cast<int32>(exprNode.evaluate(lhs, rhs));
+        h = zero;
+    }
+
+    if (g == h)
+    {
+        return g;
+    }
+
+    if (g == one && h == zero)
+    {
+        return f;
+    }
+
+    // Standard triples. ite(f, 1, h) = ite(h, 1, f) and
+    // ite(f, g, 0) = ite(g, f, 0), the top variable goes first.
+    auto const precedes = [this] (node_t* const l, node_t* const r)
+    {
+        int32 const lLevel = nodes_.get_level(l);
+        int32 const rLevel = nodes_.get_level(r);
+        return lLevel < rLevel || (lLevel == rLevel && l < r);
     };
 
-    node_t* const newRoot = this->apply_n_impl(cache, operation, left, right);
-    auto const cacheCapacity = cache.size();
-    cache.clear();
-    cache.resize(cacheCapacity);
-    return newRoot;
+    if (g == one && precedes(h, f))
+    {
+        utils::swap(f, h);
+    }
+    else if (h == zero && precedes(g, f))
+    {
+        utils::swap(f, g);
+    }
+
+    node_t* const keys[3] {f, g, h};
+    std::size_t const hash = apply_n_cache_hash(keys, 3);
+    node_t* const cached   = apply_n_cache_find(cache, keys, hash);
+    if (cached)
+    {
+        return cached;
+    }
+
+    int32 const fLevel   = nodes_.get_level(f);
+    int32 const gLevel   = nodes_.get_level(g);
+    int32 const hLevel   = nodes_.get_level(h);
+    int32 const topLevel = utils::pack_min(fLevel, gLevel, hLevel);
+    int32 const topIndex = nodes_.get_index(topLevel);
+    son_container sons   = nodes_.make_son_container(2);
+    for (int32 k = 0; k < 2; ++k)
+    {
+        sons[k] = this->ite_impl(
+            cache,
+            zero,
+            one,
+            fLevel == topLevel ? f->get_son(k) : f,
+            gLevel == topLevel ? g->get_son(k) : g,
+            hLevel == topLevel ? h->get_son(k) : h
+        );
+    }
+
+    node_t* const result = nodes_.make_internal_node(topIndex, sons);
+    apply_n_cache_put(cache, keys, hash, result);
+    return result;
 }
 
 template<class Data, class Degree, class Domain>
-auto diagram_manager<Data, Degree, Domain>::variable_impl(int32 const index)
-    -> node_t*
+auto diagram_manager<Data, Degree, Domain>::case_of(
+    diagram_t const& selector,
+    std::span<diagram_t const> const branches
+) -> diagram_t
 {
-    int32 const varDomain = nodes_.get_domain(index);
-    son_container sons    = nodes_.make_son_container(varDomain);
-    for (int32 val = 0; val < varDomain; ++val)
+    assert(not branches.empty());
+
+    int64 const arity = ssize(branches) + 1;
+    int64 nodeCount   = this->get_node_count(selector);
+    for (diagram_t const& branch : branches)
     {
-        sons[val] = nodes_.make_terminal_node(val);
+        nodeCount += this->get_node_count(branch);
     }
-    return nodes_.make_internal_node(index, sons);
+    node_span_cache cache = make_node_span_cache(arity, nodeCount);
+
+    std::vector<node_t*> stack;
+    stack.reserve(as_usize(arity * (this->get_var_count() + 2)));
+    stack.push_back(selector.unsafe_get_root());
+    for (diagram_t const& branch : branches)
+    {
+        stack.push_back(branch.unsafe_get_root());
+    }
+
+    node_t* const newRoot = this->case_of_impl(cache, stack, 0);
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
 }
 
 template<class Data, class Degree, class Domain>
-template<teddy_bin_op Op>
-auto diagram_manager<Data, Degree, Domain>::apply(
-    diagram_t const& lhs,
-    diagram_t const& rhs
+auto diagram_manager<Data, Degree, Domain>::case_of_impl(
+    node_span_cache& cache,
+    std::vector<node_t*>& stack,
+    int64 const offset
+) -> node_t*
+{
+    int64 const arity      = cache.arity_;
+    node_t* const selector = stack[as_uindex(offset)];
+    if (selector->is_terminal())
+    {
+        assert(selector->get_value() < arity - 1);
+        return stack[as_uindex(offset + 1 + selector->get_value())];
+    }
+
+    // Selection of the same branch everywhere.
+    node_t* const first = stack[as_uindex(offset + 1)];
+    bool isSame         = true;
+    for (int64 i = 2; i < arity && isSame; ++i)
+    {
+        isSame = stack[as_uindex(offset + i)] == first;
+    }
+    if (isSame)
+    {
+        return first;
+    }
+
+    std::size_t const hash
+        = apply_n_cache_hash(stack.data() + offset, arity);
+    node_t* const cached
+        = apply_n_cache_find(cache, stack.data() + offset, hash);
+    if (cached)
+    {
+        return cached;
+    }
+
+    int32 minLevel = nodes_.get_leaf_level();
+    for (int64 i = 0; i < arity; ++i)
+    {
+        minLevel = utils::min(
+            minLevel,
+            nodes_.get_level(stack[as_uindex(offset + i)])
+        );
+    }
+
+    int32 const topIndex  = nodes_.get_index(minLevel);
+    int32 const domain    = nodes_.get_domain(topIndex);
+    son_container sons    = nodes_.make_son_container(domain);
+    int64 const sonOffset = ssize(stack);
+    for (int32 k = 0; k < domain; ++k)
+    {
+        for (int64 i = 0; i < arity; ++i)
+        {
+            node_t* const node = stack[as_uindex(offset + i)];
+            stack.push_back(
+                nodes_.get_level(node) == minLevel ? node->get_son(k) : node
+            );
+        }
+        sons[k] = this->case_of_impl(cache, stack, sonOffset);
+        stack.resize(as_usize(sonOffset));
+    }
+
+    node_t* const result = nodes_.make_internal_node(topIndex, sons);
+    apply_n_cache_put(cache, stack.data() + offset, hash, result);
+    return result;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::compose(
+    diagram_t const& diagram,
+    int32 const varIndex,
+    diagram_t const& replacement
 ) -> diagram_t
 {
-    /*
-     * Use bounded MAX if the max value is known.
-     * This should perform better since it can short-circuit.
-     */
-    using OpType = utils::type_if<
-        utils::is_same<Op, ops::MAX>::value && domains::is_fixed<Domain>::value,
-        ops::MAXB<Domain::value>,
-        Op>::type;
+    composition comp {
+        {},
+        nodes_.get_level(varIndex),
+        nodes_.make_operation_id(),
+        this->get_node_count(diagram),
+        {},
+        {},
+        {}
+    };
+    node_t* const newRoot = this->compose_impl(
+        comp,
+        varIndex,
+        diagram.unsafe_get_root(),
+        replacement.unsafe_get_root()
+    );
+    this->unmark_operands(comp.operands_, newRoot);
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
 
-    node_t* const newRoot = this->apply_impl(
-        OpType(),
-        lhs.unsafe_get_root(),
-        rhs.unsafe_get_root()
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::vector_compose(
+    diagram_t const& diagram,
+    std::vector<diagram_t> const& replacements
+) -> diagram_t
+{
+    assert(ssize(replacements) == this->get_var_count());
+
+    composition comp {
+        std::vector<node_t*>(as_usize(this->get_var_count()), nullptr),
+        -1,
+        nodes_.make_operation_id(),
+        this->get_node_count(diagram),
+        {},
+        {},
+        {}
+    };
+
+    // Variables replaced by themselves are not replaced at all.
+    for (int32 index = 0; index < this->get_var_count(); ++index)
+    {
+        node_t* const root = replacements[as_uindex(index)].unsafe_get_root();
+        bool isIdentity
+            = root->is_internal() && root->get_index() == index;
+        int32 const domain = nodes_.get_domain(index);
+        for (int32 k = 0; k < domain && isIdentity; ++k)
+        {
+            node_t* const son = root->get_son(k);
+            isIdentity        = son->is_terminal() && son->get_value() == k;
+        }
+
+        if (not isIdentity)
+        {
+            comp.replacements_[as_uindex(index)] = root;
+            comp.lastLevel_
+                = utils::max(comp.lastLevel_, nodes_.get_level(index));
+        }
+    }
+
+    node_t* const newRoot
+        = this->vector_compose_impl(comp, diagram.unsafe_get_root());
+    this->unmark_operands(comp.operands_, newRoot);
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::rename(
+    diagram_t const& diagram,
+    std::vector<int32> const& mapping
+) -> diagram_t
+{
+    assert(ssize(mapping) == this->get_var_count());
+
+    // Variables in the order of their levels.
+    std::vector<int32> indices = this->get_dependency_set(diagram);
+    utils::sort(
+        indices,
+        [this] (int32 const lhs, int32 const rhs)
+        { return nodes_.get_level(lhs) < nodes_.get_level(rhs); }
     );
+
+    bool isOrderPreserving = true;
+    int32 prevLevel        = -1;
+    for (int32 const oldIndex : indices)
+    {
+        int32 const newIndex = mapping[as_uindex(oldIndex)];
+        int32 const newLevel = nodes_.get_level(newIndex);
+        assert(nodes_.get_domain(oldIndex) == nodes_.get_domain(newIndex));
+        isOrderPreserving = isOrderPreserving && prevLevel < newLevel;
+        prevLevel         = newLevel;
+    }
+
+    if (isOrderPreserving)
+    {
+        std::unordered_map<node_t*, node_t*> memo;
+        node_t* const newRoot
+            = this->rename_impl(memo, mapping, diagram.unsafe_get_root());
+        nodes_.run_deferred();
+        return diagram_t(newRoot);
+    }
+
+    composition comp {
+        std::vector<node_t*>(as_usize(this->get_var_count()), nullptr),
+        -1,
+        nodes_.make_operation_id(),
+        this->get_node_count(diagram),
+        {},
+        {},
+        {}
+    };
+
+    for (int32 const oldIndex : indices)
+    {
+        int32 const newIndex = mapping[as_uindex(oldIndex)];
+        if (newIndex != oldIndex)
+        {
+            node_t* const variable = this->variable_impl(newIndex);
+            comp.replacements_[as_uindex(oldIndex)] = variable;
+            comp.operands_.push_back(variable);
+            comp.lastLevel_
+                = utils::max(comp.lastLevel_, nodes_.get_level(oldIndex));
+        }
+    }
+
+    node_t* const newRoot
+        = this->vector_compose_impl(comp, diagram.unsafe_get_root());
+    this->unmark_operands(comp.operands_, newRoot);
     nodes_.run_deferred();
     return diagram_t(newRoot);
 }
 
 template<class Data, class Degree, class Domain>
-template<class Op>
-auto diagram_manager<Data, Degree, Domain>::apply_impl(
-    Op operation,
-    node_t* const lhs,
-    node_t* const rhs
+auto diagram_manager<Data, Degree, Domain>::rename_impl(
+    std::unordered_map<node_t*, node_t*>& memo,
+    std::vector<int32> const& mapping,
+    node_t* const node
 ) -> node_t*
 {
-#ifdef LIBTEDDY_COLLECT_STATS
-    ++stats::get_stats().applyStepCalls_;
-#endif
+    if (node->is_terminal())
+    {
+        return node;
+    }
 
-    node_t* const cached = nodes_.template cache_find<Op>(lhs, rhs);
+    auto const memoIt = memo.find(node);
+    if (memo.end() != memoIt)
+    {
+        return memoIt->second;
+    }
+
+    int32 const index  = node->get_index();
+    int32 const domain = nodes_.get_domain(index);
+    son_container sons = nodes_.make_son_container(domain);
+    for (int32 k = 0; k < domain; ++k)
+    {
+        sons[k] = this->rename_impl(memo, mapping, node->get_son(k));
+    }
+    node_t* const newNode
+        = nodes_.make_internal_node(mapping[as_uindex(index)], sons);
+    memo.emplace(node, newNode);
+    return newNode;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::compose_impl(
+    composition& comp,
+    int32 const varIndex,
+    node_t* const node,
+    node_t* const replacement
+) -> node_t*
+{
+    // Nodes below the substituted variable are not affected.
+    int32 const nodeLevel = nodes_.get_level(node);
+    if (nodeLevel > comp.lastLevel_)
+    {
+        return node;
+    }
+
+    node_t* const cached = nodes_.cache_find(comp.opId_, node, replacement);
     if (cached)
     {
         return cached;
     }
 
-    int32 const lhsVal = lhs->is_terminal() ? lhs->get_value() : Nondetermined;
-    int32 const rhsVal = rhs->is_terminal() ? rhs->get_value() : Nondetermined;
-    int32 const opVal  = operation(lhsVal, rhsVal);
+    node_t* result = nullptr;
+    if (nodeLevel == comp.lastLevel_)
+    {
+        // The replacement selects one of the sons.
+        int32 const domain = nodes_.get_domain(varIndex);
+        son_container sons = nodes_.make_son_container(domain);
+        for (int32 k = 0; k < domain; ++k)
+        {
+            sons[k] = node->get_son(k);
+        }
+        result = this->compose_case_impl(comp, replacement, sons, domain);
+    }
+    else
+    {
+        // Above the substituted variable, both the node and
+        // the replacement are split by the top variable.
+        int32 const replacementLevel = nodes_.get_level(replacement);
+        int32 const topLevel = utils::min(nodeLevel, replacementLevel);
+        int32 const topIndex = nodes_.get_index(topLevel);
+        int32 const domain   = nodes_.get_domain(topIndex);
+        son_container sons   = nodes_.make_son_container(domain);
+        for (int32 k = 0; k < domain; ++k)
+        {
+            node_t* const fst
+                = nodeLevel == topLevel ? node->get_son(k) : node;
+            node_t* const snd = replacementLevel == topLevel
+                                  ? replacement->get_son(k)
+                                  : replacement;
+            sons[k] = this->compose_impl(comp, varIndex, fst, snd);
+        }
+        result = nodes_.make_internal_node(topIndex, sons);
+    }
 
-    if (opVal != Nondetermined)
+    nodes_.cache_put(comp.opId_, result, node, replacement);
+    return result;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::vector_compose_impl(
+    composition& comp,
+    node_t* const node
+) -> node_t*
+{
+    // Nodes below the last replaced variable are not affected.
+    int32 const level = nodes_.get_level(node);
+    if (level > comp.lastLevel_)
     {
-        node_t* const result = nodes_.make_terminal_node(opVal);
-        nodes_.template cache_put<Op>(result, lhs, rhs);
-        return result;
+        return node;
     }
 
-    int32 const lhsLevel = nodes_.get_level(lhs);
-    int32 const rhsLevel = nodes_.get_level(rhs);
-    int32 const topLevel = utils::min(lhsLevel, rhsLevel);
-    int32 const topIndex = nodes_.get_index(topLevel);
-    int32 const domain   = nodes_.get_domain(topIndex);
-    son_container sons   = nodes_.make_son_container(domain);
+    node_t* const cached = nodes_.cache_find(comp.opId_, node, node);
+    if (cached)
+    {
+        return cached;
+    }
+
+    int32 const index  = node->get_index();
+    int32 const domain = nodes_.get_domain(index);
+    son_container sons = nodes_.make_son_container(domain);
+    bool isBelow       = true;
     for (int32 k = 0; k < domain; ++k)
     {
-        sons[k] = this->apply_impl(
-            operation,
-            lhsLevel == topLevel ? lhs->get_son(k) : lhs,
-            rhsLevel == topLevel ? rhs->get_son(k) : rhs
-        );
+        sons[k] = this->vector_compose_impl(comp, node->get_son(k));
+        isBelow = isBelow && nodes_.get_level(sons[k]) > level;
     }
 
-    node_t* const result = nodes_.make_internal_node(topIndex, sons);
-    nodes_.template cache_put<Op>(result, lhs, rhs);
+    // If the variable is not replaced and the sons do not depend on
+    // variables above it, the node can be created directly.
+    node_t* const replacement = comp.replacements_[as_uindex(index)];
+    node_t* result            = nullptr;
+    if (not replacement && isBelow)
+    {
+        result = nodes_.make_internal_node(index, sons);
+    }
+    else
+    {
+        node_t* const selector
+            = replacement ? replacement : this->variable_impl(index);
+        result = this->compose_case_impl(comp, selector, sons, domain);
+    }
+
+    nodes_.cache_put(comp.opId_, result, node, node);
     return result;
 }
 
-template<class Data, class Degree, class Domain>
-template<teddy_bin_op Op, class... Diagram>
-auto diagram_manager<Data, Degree, Domain>::apply_n(Diagram const&... diagram)
-    -> diagram_t
-{
-    /*
-     * Use bounded MAX if the max value is known.
-     * This should perform better since it can short-circuit.
-     */
-    using OpType = utils::type_if<
-        utils::is_same<Op, ops::MAX>::value && domains::is_fixed<Domain>::value,
-        ops::MAXB<Domain::value>,
-        Op>::type;
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::compose_case_impl(
+    composition& comp,
+    node_t* const selector,
+    son_container const& branches,
+    int32 const domain
+) -> node_t*
+{
+    if (ssize(comp.caseCaches_) <= domain)
+    {
+        comp.caseCaches_.resize(as_usize(domain + 1), node_span_cache {});
+    }
+
+    node_span_cache& cache = comp.caseCaches_[as_uindex(domain)];
+    if (cache.arity_ == 0)
+    {
+        cache = make_node_span_cache(domain + 1, comp.nodeCount_);
+    }
+
+    int64 const offset = ssize(comp.stack_);
+    comp.stack_.push_back(selector);
+    comp.operands_.push_back(selector);
+    for (int32 k = 0; k < domain; ++k)
+    {
+        comp.stack_.push_back(branches[k]);
+        comp.operands_.push_back(branches[k]);
+    }
+
+    // Same as make_internal_node, takes ownership of the branches.
+    if constexpr (degrees::is_mixed<Degree>::value)
+    {
+        node_t::delete_son_container(branches);
+    }
 
-    // TODO capacity
-    std::vector<node_pack<sizeof...(Diagram)>, node_t*> cache(100'000);
-    node_t* const newRoot
-        = this->apply_n_impl(cache, OpType(), diagram.unsafe_get_root()...);
-    nodes_.run_deferred();
-    return diagram_t(newRoot);
+    node_t* const result = this->case_of_impl(cache, comp.stack_, offset);
+    comp.stack_.resize(as_usize(offset));
+    return result;
 }
 
 template<class Data, class Degree, class Domain>
@@ -1381,37 +3960,568 @@ auto diagram_manager<Data, Degree, Domain>::tree_fold(I first, S const last)
 
         for (int64 i = 0; i < pairCount; ++i)
         {
-            *(first + i)
-                = this->apply<Op>(*(first + 2 * i), *(first + 2 * i + 1));
+            *(first + i)
+                = this->apply<Op>(*(first + 2 * i), *(first + 2 * i + 1));
+        }
+
+        if (justMoveLast)
+        {
+            *(first + currentCount - 1)
+                = static_cast<diagram_t&&>(*(first + 2 * (currentCount - 1)));
+        }
+    }
+
+    return diagram_t(static_cast<diagram_t&&>(*first));
+}
+
+template<class Data, class Degree, class Domain>
+template<teddy_bin_op Op, std::ranges::random_access_range R>
+auto diagram_manager<Data, Degree, Domain>::tree_fold_parallel(
+    R const& diagrams,
+    int32 const threadCount
+) -> diagram_t
+{
+    auto const first = std::ranges::begin(diagrams);
+    auto const count = static_cast<int64>(std::ranges::size(diagrams));
+
+    // Each worker should merge at least two diagrams.
+    auto const workerCount
+        = static_cast<int32>(utils::min(int64 {threadCount}, count / 2));
+    if (workerCount < 2)
+    {
+        std::vector<diagram_t> part(first, first + count);
+        return this->tree_fold<Op>(part);
+    }
+
+    // Results are declared after managers so they are destroyed first.
+    std::vector<diagram_manager> workers;
+    workers.reserve(as_usize(workerCount));
+    for (int32 i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(this->make_worker_impl());
+    }
+    std::vector<diagram_t> partResults(as_usize(workerCount));
+
+    // Workers only read nodes of this manager.
+    auto const fold_part = [&] (int32 const workerId)
+    {
+        diagram_manager& worker = workers[as_uindex(workerId)];
+        int64 const partFirst   = count * workerId / workerCount;
+        int64 const partLast    = count * (workerId + 1) / workerCount;
+        std::unordered_map<node_t*, node_t*> memo;
+        std::vector<diagram_t> part;
+        part.reserve(as_usize(partLast - partFirst));
+        for (int64 i = partFirst; i < partLast; ++i)
+        {
+            node_t* const root
+                = worker.transfer_impl((first + i)->unsafe_get_root(), memo);
+            worker.nodes_.run_deferred();
+            part.emplace_back(root);
+        }
+        partResults[as_uindex(workerId)] = worker.template tree_fold<Op>(part);
+    };
+
+    std::vector<std::thread> threads;
+    for (int32 i = 1; i < workerCount; ++i)
+    {
+        threads.emplace_back(fold_part, i);
+    }
+    fold_part(0);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<diagram_t> results;
+    results.reserve(as_usize(workerCount));
+    for (int32 i = 0; i < workerCount; ++i)
+    {
+        results.emplace_back(this->transfer(
+            workers[as_uindex(i)],
+            partResults[as_uindex(i)]
+        ));
+    }
+    return this->tree_fold<Op>(results);
+}
+
+template<class Data, class Degree, class Domain>
+template<teddy_bin_op Op, std::ranges::random_access_range R>
+auto diagram_manager<Data, Degree, Domain>::size_ordered_fold(R& diagrams)
+    -> diagram_t
+{
+    struct heap_entry
+    {
+        int64 nodeCount_;
+        int64 position_;
+    };
+
+    auto const first = std::ranges::begin(diagrams);
+    auto const count = static_cast<int64>(std::ranges::size(diagrams));
+    assert(count > 0);
+
+    // Min-heap of positions in the range ordered by node counts.
+    std::vector<heap_entry> heap;
+    heap.reserve(as_usize(count));
+    for (int64 i = 0; i < count; ++i)
+    {
+        heap.push_back({this->get_node_count(*(first + i)), i});
+    }
+
+    auto const sift_down = [&heap] (int64 parent)
+    {
+        int64 const size = ssize(heap);
+        for (;;)
+        {
+            int64 const left  = 2 * parent + 1;
+            int64 const right = left + 1;
+            int64 smallest    = parent;
+            if (left < size && heap[as_uindex(left)].nodeCount_
+                                   < heap[as_uindex(smallest)].nodeCount_)
+            {
+                smallest = left;
+            }
+            if (right < size && heap[as_uindex(right)].nodeCount_
+                                    < heap[as_uindex(smallest)].nodeCount_)
+            {
+                smallest = right;
+            }
+            if (smallest == parent)
+            {
+                return;
+            }
+            utils::swap(heap[as_uindex(parent)], heap[as_uindex(smallest)]);
+            parent = smallest;
+        }
+    };
+
+    for (int64 i = count / 2; i > 0;)
+    {
+        --i;
+        sift_down(i);
+    }
+
+    while (ssize(heap) > 1)
+    {
+        // Removes the smallest entry, the second smallest is then on top
+        // and its slot is reused for the result.
+        int64 const lhs = heap.front().position_;
+        heap.front()    = heap.back();
+        heap.pop_back();
+        sift_down(0);
+        int64 const rhs = heap.front().position_;
+
+        // Result is stored at the lower position, the other one is released.
+        int64 const lower = utils::min(lhs, rhs);
+        int64 const upper = utils::max(lhs, rhs);
+        *(first + lower)  = this->apply<Op>(*(first + lower), *(first + upper));
+        *(first + upper)  = diagram_t();
+        heap.front()      = {this->get_node_count(*(first + lower)), lower};
+        sift_down(0);
+    }
+
+    int64 const last = heap.front().position_;
+    return diagram_t(static_cast<diagram_t&&>(*(first + last)));
+}
+
+template<class Data, class Degree, class Domain>
+template<teddy_bin_op Op, std::ranges::random_access_range R>
+auto diagram_manager<Data, Degree, Domain>::fold(
+    R& diagrams,
+    fold_type const foldType
+) -> diagram_t
+{
+    switch (foldType)
+    {
+    case fold_type::Left:
+        return this->left_fold<Op>(diagrams);
+
+    case fold_type::Tree:
+        return this->tree_fold<Op>(diagrams);
+
+    case fold_type::SizeOrdered:
+        return this->size_ordered_fold<Op>(diagrams);
+
+    default:
+        assert(false);
+        return this->constant(0);
+    }
+}
+
+template<class Data, class Degree, class Domain>
+template<in_var_values Vars>
+auto diagram_manager<Data, Degree, Domain>::evaluate(
+    diagram_t const& diagram,
+    Vars const& values
+) const -> int32
+{
+    node_t* node = diagram.unsafe_get_root();
+
+    while (not node->is_terminal())
+    {
+        int32 const index = node->get_index();
+        assert(nodes_.is_valid_var_value(index, values[as_uindex(index)]));
+        node = node->get_son(values[as_uindex(index)]);
+    }
+
+    return node->get_value();
+}
+
+template<class Data, class Degree, class Domain>
+template<std::ranges::random_access_range Vs, std::output_iterator<int32> O>
+auto diagram_manager<Data, Degree, Domain>::evaluate_many(
+    diagram_t const& diagram,
+    Vs const& assignments,
+    O out
+) const -> void
+{
+    static_assert(in_var_values<std::ranges::range_value_t<Vs>>);
+    std::vector<int32> flat;
+    int32 const root = this->to_flat_impl(diagram.unsafe_get_root(), flat);
+    details::evaluate_flat_many(
+        flat,
+        root,
+        this->get_domains(),
+        assignments,
+        out
+    );
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::compile(diagram_t const& diagram
+) const -> compiled_diagram
+{
+    std::vector<int32> flat;
+    int32 const root = this->to_flat_impl(diagram.unsafe_get_root(), flat);
+    return compiled_diagram(
+        static_cast<std::vector<int32>&&>(flat),
+        root,
+        this->get_order(),
+        this->get_domains()
+    );
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::simulate_bits(
+    diagram_t const& diagram,
+    std::vector<std::vector<uint64>> const& columns
+) const -> utils::second_t<Foo, std::vector<uint64>>
+{
+    assert(ssize(columns) == this->get_var_count());
+
+    int64 const wordCount = columns.empty() ? 1 : ssize(columns[0]);
+    auto const terminal_word = [] (int32 const value)
+    { return value == 1 ? ~uint64(0) : uint64(0); };
+
+    std::vector<int32> flat;
+    int32 const root = this->to_flat_impl(diagram.unsafe_get_root(), flat);
+    if (root < 0)
+    {
+        return std::vector<uint64>(as_usize(wordCount), terminal_word(~root));
+    }
+
+    // Each record of the flat array is [index, son0, son1]. Records are
+    // ordered by levels so the reverse order visits sons before fathers.
+    int64 constexpr RecordSize = 3;
+    int64 const recordCount    = ssize(flat) / RecordSize;
+    std::vector<uint64> words(as_usize(recordCount * wordCount));
+    auto const son_word = [&] (int32 const son, int64 const word)
+    {
+        if (son < 0)
+        {
+            return terminal_word(~son);
+        }
+        int64 const sonRecord = son / RecordSize;
+        return words[as_uindex(sonRecord * wordCount + word)];
+    };
+
+    for (int64 record = recordCount - 1; record >= 0; --record)
+    {
+        int64 const position = record * RecordSize;
+        int32 const index    = flat[as_uindex(position)];
+        int32 const son0     = flat[as_uindex(position + 1)];
+        int32 const son1     = flat[as_uindex(position + 2)];
+        std::vector<uint64> const& column = columns[as_uindex(index)];
+        assert(ssize(column) == wordCount);
+        for (int64 word = 0; word < wordCount; ++word)
+        {
+            uint64 const select = column[as_uindex(word)];
+            words[as_uindex(record * wordCount + word)]
+                = (select & son_word(son1, word))
+                | (~select & son_word(son0, word));
+        }
+    }
+
+    return std::vector<uint64>(
+        words.begin(),
+        words.begin() + static_cast<std::ptrdiff_t>(wordCount)
+    );
+}
+
+template<class Data, class Degree, class Domain>
+template<class O>
+auto diagram_manager<Data, Degree, Domain>::to_vector_impl(
+    node_t* const node,
+    int32 const level,
+    O& out
+) const -> void
+{
+    int32 const nodeLevel = nodes_.get_level(node);
+    int64 const repeat    = nodes_.domain_product(level, nodeLevel);
+    if (node->is_terminal())
+    {
+        int32 const value = node->get_value();
+        for (int64 i = 0; i < repeat; ++i)
+        {
+            *out++ = value;
+        }
+        return;
+    }
+
+    int32 const domain = nodes_.get_domain(node);
+    for (int64 i = 0; i < repeat; ++i)
+    {
+        for (int32 k = 0; k < domain; ++k)
+        {
+            this->to_vector_impl(node->get_son(k), nodeLevel + 1, out);
+        }
+    }
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::to_vector_impl(
+    node_t* const node,
+    int32 const level,
+    int32* const out,
+    std::unordered_map<node_t*, int32 const*>& memo
+) const -> void
+{
+    int32 const nodeLevel = nodes_.get_level(node);
+    int64 const repeat    = nodes_.domain_product(level, nodeLevel);
+    if (node->is_terminal())
+    {
+        int32 const value = node->get_value();
+        for (int64 i = 0; i < repeat; ++i)
+        {
+            out[i] = value;
+        }
+        return;
+    }
+
+    // Slab of the node itself, subsequent repetitions (skipped levels)
+    // are copies of it.
+    int32 const varCount = this->get_var_count();
+    int64 const slabSize = nodes_.domain_product(nodeLevel, varCount);
+    auto const bytes     = static_cast<std::size_t>(slabSize) * sizeof(int32);
+    auto const memoIt    = memo.find(node);
+    if (memoIt != memo.end())
+    {
+        std::memcpy(out, memoIt->second, bytes);
+    }
+    else
+    {
+        int32 const domain  = nodes_.get_domain(node);
+        int64 const sonSize = nodes_.domain_product(nodeLevel + 1, varCount);
+        for (int32 k = 0; k < domain; ++k)
+        {
+            this->to_vector_impl(
+                node->get_son(k),
+                nodeLevel + 1,
+                out + k * sonSize,
+                memo
+            );
+        }
+        memo.emplace(node, out);
+    }
+
+    for (int64 i = 1; i < repeat; ++i)
+    {
+        std::memcpy(out + i * slabSize, out, bytes);
+    }
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::make_worker_impl() const
+    -> diagram_manager
+{
+    int64 constexpr WorkerNodePoolSize = 100'000;
+    if constexpr (domains::is_mixed<Domain>::value)
+    {
+        return diagram_manager(
+            this->get_var_count(),
+            WorkerNodePoolSize,
+            WorkerNodePoolSize / 2,
+            domains::mixed(this->get_domains()),
+            this->get_order()
+        );
+    }
+    else
+    {
+        return diagram_manager(
+            this->get_var_count(),
+            WorkerNodePoolSize,
+            WorkerNodePoolSize / 2,
+            this->get_order()
+        );
+    }
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::transfer_impl(
+    node_t* const node,
+    std::unordered_map<node_t*, node_t*>& memo
+) -> node_t*
+{
+    if (node->is_terminal())
+    {
+        return nodes_.make_terminal_node(node->get_value());
+    }
+
+    auto const memoIt = memo.find(node);
+    if (memoIt != memo.end())
+    {
+        return memoIt->second;
+    }
+
+    int32 const index  = node->get_index();
+    int32 const domain = nodes_.get_domain(index);
+    son_container sons = nodes_.make_son_container(domain);
+    for (int32 k = 0; k < domain; ++k)
+    {
+        sons[k] = this->transfer_impl(node->get_son(k), memo);
+    }
+
+    node_t* const newNode = nodes_.make_internal_node(index, sons);
+    memo.emplace(node, newNode);
+    return newNode;
+}
+
+template<class Data, class Degree, class Domain>
+template<class I>
+auto diagram_manager<Data, Degree, Domain>::stage_vector_impl(
+    I const first,
+    int32 const level,
+    std::vector<int32>& records,
+    std::unordered_multimap<std::size_t, int32>& unique,
+    std::vector<int32>& stack
+) const -> int32
+{
+    int32 const index    = nodes_.get_index(level);
+    int32 const domain   = nodes_.get_domain(index);
+    int32 const varCount = this->get_var_count();
+    int64 const sonSize  = nodes_.domain_product(level + 1, varCount);
+
+    // Sons are pushed on top of the shared stack, sons of the sons
+    // are popped before the next son is pushed.
+    for (int32 k = 0; k < domain; ++k)
+    {
+        int32 const son = level + 1 == varCount
+                            ? ~static_cast<int32>(*(first + k))
+                            : this->stage_vector_impl(
+                                  first + k * sonSize,
+                                  level + 1,
+                                  records,
+                                  unique,
+                                  stack
+                              );
+        stack.push_back(son);
+    }
+    int32 const* const sons = stack.data() + ssize(stack) - domain;
+    auto const pop_sons     = [&stack, domain] ()
+    { stack.resize(stack.size() - as_usize(domain)); };
+
+    // Redundant node.
+    bool isRedundant = true;
+    for (int32 k = 1; k < domain && isRedundant; ++k)
+    {
+        isRedundant = sons[k] == sons[0];
+    }
+    if (isRedundant)
+    {
+        int32 const son = sons[0];
+        pop_sons();
+        return son;
+    }
+
+    // Duplicate node.
+    std::size_t hash = utils::do_hash(index);
+    for (int32 k = 0; k < domain; ++k)
+    {
+        utils::add_hash(hash, sons[k]);
+    }
+    auto [it, end] = unique.equal_range(hash);
+    for (; it != end; ++it)
+    {
+        int32 const offset = it->second;
+        bool isSame = records[as_uindex(offset)] == index;
+        for (int32 k = 0; k < domain && isSame; ++k)
+        {
+            isSame = records[as_uindex(offset + 1 + k)] == sons[k];
         }
-
-        if (justMoveLast)
+        if (isSame)
         {
-            *(first + currentCount - 1)
-                = static_cast<diagram_t&&>(*(first + 2 * (currentCount - 1)));
+            pop_sons();
+            return offset;
         }
     }
 
-    return diagram_t(static_cast<diagram_t&&>(*first));
+    // New node.
+    auto const offset = static_cast<int32>(ssize(records));
+    records.push_back(index);
+    records.insert(records.end(), sons, sons + domain);
+    unique.emplace(hash, offset);
+    pop_sons();
+    return offset;
 }
 
 template<class Data, class Degree, class Domain>
-template<in_var_values Vars>
-auto diagram_manager<Data, Degree, Domain>::evaluate(
-    diagram_t const& diagram,
-    Vars const& values
+auto diagram_manager<Data, Degree, Domain>::to_flat_impl(
+    node_t* const root,
+    std::vector<int32>& flat
 ) const -> int32
 {
-    node_t* node = diagram.unsafe_get_root();
+    // Each internal node is stored as a record [index, son0, son1, ...].
+    // Sons are either positions of other records or terminals
+    // stored as bitwise complement of their values.
+    if (root->is_terminal())
+    {
+        return ~root->get_value();
+    }
 
-    while (not node->is_terminal())
+    std::vector<node_t*> internals;
+    std::unordered_map<node_t*, int32> positions;
+    int32 position = 0;
+    nodes_.traverse_level(
+        root,
+        [this, &internals, &positions, &position] (node_t* const node)
+        {
+            if (node->is_internal())
+            {
+                internals.push_back(node);
+                positions.emplace(node, position);
+                position += 1 + nodes_.get_domain(node);
+            }
+        }
+    );
+
+    flat.reserve(as_usize(position));
+    for (node_t* const node : internals)
     {
-        int32 const index = node->get_index();
-        assert(nodes_.is_valid_var_value(index, values[as_uindex(index)]));
-        node = node->get_son(values[as_uindex(index)]);
+        flat.push_back(node->get_index());
+        nodes_.for_each_son(
+            node,
+            [&flat, &positions] (node_t* const son)
+            {
+                flat.push_back(
+                    son->is_terminal() ? ~son->get_value()
+                                       : positions.find(son)->second
+                );
+            }
+        );
     }
 
-    return node->get_value();
+    return 0;
 }
 
 template<class Data, class Degree, class Domain>
@@ -1657,114 +4767,519 @@ auto diagram_manager<Data, Degree, Domain>::get_cofactor(
     int32 toCofactor = static_cast<int32>(vars.size());
     if (it != vars.end())
     {
-        root = root->get_son(it->value_);
-        --toCofactor;
+        root = root->get_son(it->value_);
+        --toCofactor;
+    }
+
+    std::unordered_map<node_t*, node_t*> memo;
+    diagram_t result = diagram_t(this->get_cofactor_impl(
+        memo,
+        vars,
+        root,
+        toCofactor
+    ));
+    nodes_.run_deferred();
+    return result;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::get_cofactor_impl(
+    std::unordered_map<node_t*, node_t*>& memo,
+    int32 const varIndex,
+    int32 const varValue,
+    node_t* const node
+) -> node_t*
+{
+    auto const memoIt = memo.find(node);
+    if (memoIt != memo.end())
+    {
+        return memoIt->second;
+    }
+
+    if (node->is_terminal())
+    {
+        return node;
+    }
+
+    int32 const nodeIndex = node->get_index();
+    if (nodeIndex == varIndex)
+    {
+        return node->get_son(varValue);
+    }
+
+    int32 const nodeDomain = nodes_.get_domain(node);
+    son_container sons     = nodes_.make_son_container(nodeDomain);
+    for (int32 k = 0; k < nodeDomain; ++k)
+    {
+        node_t* const oldSon = node->get_son(k);
+        sons[k] = this->get_cofactor_impl(memo, varIndex, varValue, oldSon);
+    }
+
+    node_t* const newNode = nodes_.make_internal_node(nodeIndex, sons);
+    memo.emplace(node, newNode);
+    return newNode;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::get_cofactor_impl(
+    std::unordered_map<node_t*, node_t*>& memo,
+    std::vector<var_cofactor> const& vars,
+    node_t* const node,
+    int32 const toCofactor
+) -> node_t*
+{
+    if (toCofactor == 0)
+    {
+        return node;
+    }
+
+    auto const memoIt = memo.find(node);
+    if (memoIt != memo.end())
+    {
+        return memoIt->second;
+    }
+
+    if (node->is_terminal())
+    {
+        return node;
+    }
+
+    int32 const nodeIndex = node->get_index();
+    auto const it = utils::find_if(vars.begin(), vars.end(),
+        [nodeIndex](var_cofactor var)
+    {
+        return var.index_ == nodeIndex;
+    });
+
+    node_t* newNode = nullptr;
+    if (it != vars.end())
+    {
+        newNode = this->get_cofactor_impl(
+            memo,
+            vars,
+            node->get_son(it->value_),
+            toCofactor - 1
+        );
+    }
+    else
+    {
+        int32 const nodeDomain = nodes_.get_domain(node);
+        son_container sons     = nodes_.make_son_container(nodeDomain);
+        for (int32 k = 0; k < nodeDomain; ++k)
+        {
+            node_t* const oldSon = node->get_son(k);
+            sons[k] = this->get_cofactor_impl(memo, vars, oldSon, toCofactor);
+        }
+        newNode = nodes_.make_internal_node(nodeIndex, sons);
+    }
+
+    memo.emplace(node, newNode);
+    return newNode;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::constrain(
+    diagram_t const& diagram,
+    diagram_t const& careSet
+) -> diagram_t
+{
+    std::vector<node_t*> operands;
+    node_t* const newRoot = this->constrain_impl(
+        nodes_.make_operation_id(),
+        operands,
+        false,
+        diagram.unsafe_get_root(),
+        careSet.unsafe_get_root()
+    );
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::restrict(
+    diagram_t const& diagram,
+    diagram_t const& careSet
+) -> diagram_t
+{
+    std::vector<node_t*> operands;
+    node_t* const newRoot = this->constrain_impl(
+        nodes_.make_operation_id(),
+        operands,
+        true,
+        diagram.unsafe_get_root(),
+        careSet.unsafe_get_root()
+    );
+    this->unmark_operands(operands, newRoot);
+    nodes_.run_deferred();
+
+    // Restriction is a heuristic, it can also enlarge the diagram.
+    diagram_t restricted(newRoot);
+    return this->get_node_count(restricted) <= this->get_node_count(diagram)
+             ? restricted
+             : diagram;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::constrain_impl(
+    int32 const opId,
+    std::vector<node_t*>& operands,
+    bool const isRestrict,
+    node_t* const node,
+    node_t* const careSet
+) -> node_t*
+{
+    assert(not careSet->is_terminal() || careSet->get_value() == 1);
+
+    // Terminal cases.
+    if (careSet->is_terminal() || node->is_terminal())
+    {
+        return node;
+    }
+
+    if (node == careSet)
+    {
+        return nodes_.make_terminal_node(1);
+    }
+
+    node_t* const cached = nodes_.cache_find(opId, node, careSet);
+    if (cached)
+    {
+        return cached;
+    }
+
+    int32 const nodeLevel = nodes_.get_level(node);
+    int32 const careLevel = nodes_.get_level(careSet);
+    int32 const topLevel  = utils::min(nodeLevel, careLevel);
+    int32 const topIndex  = nodes_.get_index(topLevel);
+    int32 const domain    = nodes_.get_domain(topIndex);
+    node_t* result        = nullptr;
+    if (isRestrict && careLevel < nodeLevel)
+    {
+        // The function does not depend on the variable,
+        // it is abstracted from the care set.
+        node_t* newCareSet = careSet->get_son(0);
+        for (int32 k = 1; k < domain; ++k)
+        {
+            node_t* const son = careSet->get_son(k);
+            operands.push_back(newCareSet);
+            operands.push_back(son);
+            newCareSet = this->apply_impl(ops::OR(), newCareSet, son);
+        }
+        operands.push_back(newCareSet);
+        result = this->constrain_impl(
+            opId,
+            operands,
+            isRestrict,
+            node,
+            newCareSet
+        );
+    }
+    else
+    {
+        auto const node_son = [&] (int32 const k)
+        { return nodeLevel == topLevel ? node->get_son(k) : node; };
+        auto const care_son = [&] (int32 const k)
+        { return careLevel == topLevel ? careSet->get_son(k) : careSet; };
+        auto const is_care = [&] (int32 const k)
+        {
+            node_t* const son = care_son(k);
+            return not son->is_terminal() || son->get_value() != 0;
+        };
+
+        int32 careCount = 0;
+        int32 firstCare = -1;
+        for (int32 k = 0; k < domain; ++k)
+        {
+            if (is_care(k))
+            {
+                firstCare = careCount == 0 ? k : firstCare;
+                ++careCount;
+            }
+        }
+
+        if (careCount == 1)
+        {
+            // Only one son is in the care set, the variable is dropped.
+            result = this->constrain_impl(
+                opId,
+                operands,
+                isRestrict,
+                node_son(firstCare),
+                care_son(firstCare)
+            );
+        }
+        else
+        {
+            // Sons outside of the care set are replaced by the first
+            // son inside of it.
+            son_container sons = nodes_.make_son_container(domain);
+            for (int32 k = 0; k < domain; ++k)
+            {
+                sons[k] = is_care(k) ? this->constrain_impl(
+                                           opId,
+                                           operands,
+                                           isRestrict,
+                                           node_son(k),
+                                           care_son(k)
+                                       )
+                                     : nullptr;
+            }
+            for (int32 k = 0; k < domain; ++k)
+            {
+                sons[k] = sons[k] ? sons[k] : sons[firstCare];
+            }
+            result = nodes_.make_internal_node(topIndex, sons);
+        }
+    }
+
+    nodes_.cache_put(opId, result, node, careSet);
+    return result;
+}
+
+template<class Data, class Degree, class Domain>
+template<teddy_bin_op Op>
+requires(Op::is_commutative() && details::is_associative<Op>::value)
+auto diagram_manager<Data, Degree, Domain>::abstract(
+    diagram_t const& diagram,
+    std::vector<int32> const& varIndices
+) -> diagram_t
+{
+    using OpType = utils::type_if<
+        utils::is_same<Op, ops::MAX>::value && domains::is_fixed<Domain>::value,
+        ops::MAXB<Domain::value>,
+        Op>::type;
+
+    abstracted_vars vars  = this->make_abstracted_vars(varIndices);
+    int32 const opId      = nodes_.make_operation_id();
+    node_t* const newRoot = this->abstract_impl(
+        OpType(),
+        opId,
+        vars,
+        diagram.unsafe_get_root()
+    );
+    this->unmark_operands(vars.operands_, newRoot);
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::exists(
+    diagram_t const& diagram,
+    std::vector<int32> const& varIndices
+) -> utils::second_t<Foo, diagram_t>
+{
+    return this->template abstract<ops::OR>(diagram, varIndices);
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::forall(
+    diagram_t const& diagram,
+    std::vector<int32> const& varIndices
+) -> utils::second_t<Foo, diagram_t>
+{
+    return this->template abstract<ops::AND>(diagram, varIndices);
+}
+
+template<class Data, class Degree, class Domain>
+template<class Foo>
+requires(is_bdd<Degree>)
+auto diagram_manager<Data, Degree, Domain>::and_exists(
+    diagram_t const& lhs,
+    diagram_t const& rhs,
+    std::vector<int32> const& varIndices
+) -> utils::second_t<Foo, diagram_t>
+{
+    abstracted_vars vars   = this->make_abstracted_vars(varIndices);
+    int32 const opId       = nodes_.make_operation_id();
+    int32 const existsOpId = nodes_.make_operation_id();
+    node_t* const newRoot  = this->and_exists_impl(
+        opId,
+        existsOpId,
+        vars,
+        lhs.unsafe_get_root(),
+        rhs.unsafe_get_root()
+    );
+    this->unmark_operands(vars.operands_, newRoot);
+    nodes_.run_deferred();
+    return diagram_t(newRoot);
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::make_abstracted_vars(
+    std::vector<int32> const& varIndices
+) const -> abstracted_vars
+{
+    abstracted_vars vars {
+        std::vector<bool>(as_usize(this->get_var_count()), false),
+        -1,
+        {}
+    };
+    for (int32 const index : varIndices)
+    {
+        int32 const level                     = nodes_.get_level(index);
+        vars.isAbstracted_[as_uindex(level)] = true;
+        vars.lastLevel_ = utils::max(vars.lastLevel_, level);
     }
-
-    std::unordered_map<node_t*, node_t*> memo;
-    diagram_t result = diagram_t(this->get_cofactor_impl(
-        memo,
-        vars,
-        root,
-        toCofactor
-    ));
-    nodes_.run_deferred();
-    return result;
+    return vars;
 }
 
 template<class Data, class Degree, class Domain>
-auto diagram_manager<Data, Degree, Domain>::get_cofactor_impl(
-    std::unordered_map<node_t*, node_t*>& memo,
-    int32 const varIndex,
-    int32 const varValue,
+template<class Op>
+auto diagram_manager<Data, Degree, Domain>::abstract_impl(
+    Op operation,
+    int32 const opId,
+    abstracted_vars& vars,
     node_t* const node
 ) -> node_t*
 {
-    auto const memoIt = memo.find(node);
-    if (memoIt != memo.end())
+    // Nodes below the last abstracted level are not affected.
+    int32 const level = nodes_.get_level(node);
+    if (level > vars.lastLevel_)
     {
-        return memoIt->second;
+        return node;
     }
 
-    if (node->is_terminal())
+    node_t* const cached = nodes_.cache_find(opId, node, node);
+    if (cached)
     {
-        return node;
+        return cached;
     }
 
-    int32 const nodeIndex = node->get_index();
-    if (nodeIndex == varIndex)
+    int32 const nodeIndex  = node->get_index();
+    int32 const nodeDomain = nodes_.get_domain(nodeIndex);
+    node_t* result         = nullptr;
+    if (vars.isAbstracted_[as_uindex(level)])
     {
-        return node->get_son(varValue);
+        // Merges abstractions of the sons, stops when the result
+        // can not change anymore, e.g., 1 for OR.
+        result = this->abstract_impl(operation, opId, vars, node->get_son(0));
+        for (int32 k = 1; k < nodeDomain; ++k)
+        {
+            if (result->is_terminal()
+                && operation(result->get_value(), Nondetermined)
+                       != Nondetermined)
+            {
+                break;
+            }
+            node_t* const son
+                = this->abstract_impl(operation, opId, vars, node->get_son(k));
+            vars.operands_.push_back(result);
+            vars.operands_.push_back(son);
+            result = this->apply_impl(operation, result, son);
+        }
     }
-
-    int32 const nodeDomain = nodes_.get_domain(node);
-    son_container sons     = nodes_.make_son_container(nodeDomain);
-    for (int32 k = 0; k < nodeDomain; ++k)
+    else
     {
-        node_t* const oldSon = node->get_son(k);
-        sons[k] = this->get_cofactor_impl(memo, varIndex, varValue, oldSon);
+        son_container sons = nodes_.make_son_container(nodeDomain);
+        for (int32 k = 0; k < nodeDomain; ++k)
+        {
+            sons[k]
+                = this->abstract_impl(operation, opId, vars, node->get_son(k));
+        }
+        result = nodes_.make_internal_node(nodeIndex, sons);
     }
 
-    node_t* const newNode = nodes_.make_internal_node(nodeIndex, sons);
-    memo.emplace(node, newNode);
-    return newNode;
+    nodes_.cache_put(opId, result, node, node);
+    return result;
 }
 
 template<class Data, class Degree, class Domain>
-auto diagram_manager<Data, Degree, Domain>::get_cofactor_impl(
-    std::unordered_map<node_t*, node_t*>& memo,
-    std::vector<var_cofactor> const& vars,
-    node_t* const node,
-    int32 const toCofactor
+auto diagram_manager<Data, Degree, Domain>::and_exists_impl(
+    int32 const opId,
+    int32 const existsOpId,
+    abstracted_vars& vars,
+    node_t* lhs,
+    node_t* rhs
 ) -> node_t*
 {
-    if (toCofactor == 0)
+    // Terminal cases.
+    if (lhs->is_terminal() && lhs->get_value() == 0)
     {
-        return node;
+        return lhs;
     }
 
-    auto const memoIt = memo.find(node);
-    if (memoIt != memo.end())
+    if (rhs->is_terminal() && rhs->get_value() == 0)
     {
-        return memoIt->second;
+        return rhs;
     }
 
-    if (node->is_terminal())
+    if (lhs->is_terminal() || lhs == rhs)
     {
-        return node;
+        return this->abstract_impl(ops::OR(), existsOpId, vars, rhs);
     }
 
-    int32 const nodeIndex = node->get_index();
-    auto const it = utils::find_if(vars.begin(), vars.end(),
-        [nodeIndex](var_cofactor var)
+    if (rhs->is_terminal())
     {
-        return var.index_ == nodeIndex;
-    });
+        return this->abstract_impl(ops::OR(), existsOpId, vars, lhs);
+    }
 
-    node_t* newNode = nullptr;
-    if (it != vars.end())
+    if (rhs < lhs)
     {
-        newNode = this->get_cofactor_impl(
-            memo,
-            vars,
-            node->get_son(it->value_),
-            toCofactor - 1
-        );
+        utils::swap(lhs, rhs);
     }
-    else
+
+    int32 const lhsLevel = nodes_.get_level(lhs);
+    int32 const rhsLevel = nodes_.get_level(rhs);
+    int32 const topLevel = utils::min(lhsLevel, rhsLevel);
+    if (topLevel > vars.lastLevel_)
     {
-        int32 const nodeDomain = nodes_.get_domain(node);
-        son_container sons     = nodes_.make_son_container(nodeDomain);
-        for (int32 k = 0; k < nodeDomain; ++k)
+        return this->apply_impl(ops::AND(), lhs, rhs);
+    }
+
+    node_t* const cached = nodes_.cache_find(opId, lhs, rhs);
+    if (cached)
+    {
+        return cached;
+    }
+
+    node_t* const lhs0 = lhsLevel == topLevel ? lhs->get_son(0) : lhs;
+    node_t* const lhs1 = lhsLevel == topLevel ? lhs->get_son(1) : lhs;
+    node_t* const rhs0 = rhsLevel == topLevel ? rhs->get_son(0) : rhs;
+    node_t* const rhs1 = rhsLevel == topLevel ? rhs->get_son(1) : rhs;
+    node_t* result     = nullptr;
+    if (vars.isAbstracted_[as_uindex(topLevel)])
+    {
+        // The second branch is not needed if the first one is 1.
+        result = this->and_exists_impl(opId, existsOpId, vars, lhs0, rhs0);
+        if (not result->is_terminal() || result->get_value() != 1)
         {
-            node_t* const oldSon = node->get_son(k);
-            sons[k] = this->get_cofactor_impl(memo, vars, oldSon, toCofactor);
+            node_t* const result1
+                = this->and_exists_impl(opId, existsOpId, vars, lhs1, rhs1);
+            vars.operands_.push_back(result);
+            vars.operands_.push_back(result1);
+            result = this->apply_impl(ops::OR(), result, result1);
         }
-        newNode = nodes_.make_internal_node(nodeIndex, sons);
+    }
+    else
+    {
+        son_container sons = nodes_.make_son_container(2);
+        sons[0] = this->and_exists_impl(opId, existsOpId, vars, lhs0, rhs0);
+        sons[1] = this->and_exists_impl(opId, existsOpId, vars, lhs1, rhs1);
+        result  = nodes_.make_internal_node(nodes_.get_index(topLevel), sons);
     }
 
-    memo.emplace(node, newNode);
-    return newNode;
+    nodes_.cache_put(opId, result, lhs, rhs);
+    return result;
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::unmark_operands(
+    std::vector<node_t*> const& operands,
+    node_t* const root
+) -> void
+{
+    // Operands are referenced by the result or are garbage now.
+    for (node_t* const operand : operands)
+    {
+        if (operand != root)
+        {
+            id_set_notmarked(operand);
+        }
+    }
 }
 
 template<class Data, class Degree, class Domain>
@@ -1832,7 +5347,7 @@ auto diagram_manager<Data, Degree, Domain>::get_dependency_set(
 ) const -> std::vector<int32>
 {
     std::vector<int32> indices;
-    indices.reserve(this->get_var_count());
+    indices.reserve(as_usize(this->get_var_count()));
     this->get_dependency_set_g(diagram, std::back_inserter(indices));
     indices.shrink_to_fit();
     return indices;
@@ -1848,7 +5363,7 @@ auto diagram_manager<Data, Degree, Domain>::get_dependency_set_g(
     std::vector<bool> memo(as_usize(this->get_var_count()), false);
     nodes_.traverse_pre(
         diagram.unsafe_get_root(),
-        [&memo, out] (node_t* const node) mutable
+        [&memo, &out] (node_t* const node)
         {
             if (node->is_internal())
             {
@@ -1900,6 +5415,24 @@ auto diagram_manager<Data, Degree, Domain>::to_dot_graph(
     nodes_.to_dot_graph(out, diagram.unsafe_get_root());
 }
 
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::to_dot_graph(
+    std::ostream& out,
+    diagram_t const& diagram,
+    int32 const levelFrom,
+    int32 const levelTo,
+    int64 const maxNodeCount
+) const -> void
+{
+    nodes_.to_dot_graph(
+        out,
+        diagram.unsafe_get_root(),
+        levelFrom,
+        levelTo,
+        maxNodeCount
+    );
+}
+
 template<class Data, class Degree, class Domain>
 auto diagram_manager<Data, Degree, Domain>::get_var_count() const -> int32
 {
@@ -1941,6 +5474,312 @@ auto diagram_manager<Data, Degree, Domain>::set_auto_reorder(
     nodes_.set_auto_reorder(doReorder);
 }
 
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::to_cpp_source(
+    std::ostream& out,
+    diagram_t const& diagram,
+    std::string_view const name,
+    bool const withAvailability
+) const -> void
+{
+    this->compile(diagram).to_cpp_source(out, name, withAvailability);
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::save(
+    std::vector<diagram_t> const& diagrams,
+    std::string const& path
+) const -> bool
+{
+    int32 const varCount = this->get_var_count();
+
+    // Collect nodes without using marks so that the diagrams
+    // can share nodes.
+    std::vector<std::vector<node_t*>> levels(as_usize(varCount));
+    std::vector<node_t*> terminals;
+    std::unordered_map<node_t*, int64> ids;
+    std::vector<node_t*> stack;
+    for (diagram_t const& diagram : diagrams)
+    {
+        stack.push_back(diagram.unsafe_get_root());
+        while (not stack.empty())
+        {
+            node_t* const node = stack.back();
+            stack.pop_back();
+            if (not ids.emplace(node, 0).second)
+            {
+                continue;
+            }
+
+            if (node->is_terminal())
+            {
+                terminals.push_back(node);
+                continue;
+            }
+
+            levels[as_uindex(nodes_.get_level(node))].push_back(node);
+            nodes_.for_each_son(
+                node,
+                [&stack] (node_t* const son) { stack.push_back(son); }
+            );
+        }
+    }
+
+    // Terminals go first, internal nodes follow bottom-up
+    // so that sons always precede their parents.
+    int64 nextId = 0;
+    for (node_t* const node : terminals)
+    {
+        ids[node] = nextId++;
+    }
+    for (int32 level = varCount - 1; level >= 0; --level)
+    {
+        for (node_t* const node : levels[as_uindex(level)])
+        {
+            ids[node] = nextId++;
+        }
+    }
+    int32 const width = binary::get_width(nextId);
+
+    auto ofst = std::ofstream(path, std::ios::binary);
+    if (not ofst.is_open())
+    {
+        return false;
+    }
+
+    binary::byte_writer writer(ofst);
+    for (char const c : binary::Magic)
+    {
+        writer.write(c);
+    }
+    writer.write(binary::Version);
+    writer.write(varCount);
+    for (int32 const index : this->get_order())
+    {
+        writer.write(index);
+    }
+    for (int32 const domain : this->get_domains())
+    {
+        writer.write(domain);
+    }
+    writer.write(static_cast<int64>(ssize(terminals)));
+    for (node_t* const node : terminals)
+    {
+        writer.write(node->get_value());
+    }
+    for (std::vector<node_t*> const& level : levels)
+    {
+        writer.write(static_cast<int64>(ssize(level)));
+    }
+    writer.write(width);
+    for (int32 level = varCount - 1; level >= 0; --level)
+    {
+        for (node_t* const node : levels[as_uindex(level)])
+        {
+            nodes_.for_each_son(
+                node,
+                [&] (node_t* const son)
+                { writer.write(static_cast<uint64>(ids[son]), width); }
+            );
+        }
+    }
+    writer.write(static_cast<int64>(ssize(diagrams)));
+    for (diagram_t const& diagram : diagrams)
+    {
+        writer.write(
+            static_cast<uint64>(ids[diagram.unsafe_get_root()]),
+            width
+        );
+    }
+
+    return writer.is_ok();
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::save(
+    diagram_t const& diagram,
+    std::string const& path
+) const -> bool
+{
+    return this->save(std::vector<diagram_t>({diagram}), path);
+}
+
+template<class Data, class Degree, class Domain>
+auto diagram_manager<Data, Degree, Domain>::load(std::string const& path)
+    -> std::optional<std::vector<diagram_t>>
+{
+    std::optional<mapped_file> const file = mapped_file::load_file(path);
+    if (not file)
+    {
+        return std::nullopt;
+    }
+
+    binary::byte_reader reader(file->data(), file->size());
+    for (char const c : binary::Magic)
+    {
+        if (reader.read<char>() != c)
+        {
+            return std::nullopt;
+        }
+    }
+    if (reader.read<uint32>() != binary::Version)
+    {
+        return std::nullopt;
+    }
+
+    // Order and domains must match.
+    int32 const varCount = this->get_var_count();
+    if (reader.read<int32>() != varCount)
+    {
+        return std::nullopt;
+    }
+    for (int32 const index : this->get_order())
+    {
+        if (reader.read<int32>() != index)
+        {
+            return std::nullopt;
+        }
+    }
+    for (int32 const domain : this->get_domains())
+    {
+        if (reader.read<int32>() != domain)
+        {
+            return std::nullopt;
+        }
+    }
+
+    int64 const terminalCount = reader.read<int64>();
+    if (not reader.is_ok() || terminalCount < 0
+        || terminalCount > reader.get_remaining() / 4)
+    {
+        return std::nullopt;
+    }
+    std::vector<int32> terminalValues(as_usize(terminalCount));
+    for (int32& value : terminalValues)
+    {
+        value = reader.read<int32>();
+        if (value < 0 || value >= Undefined)
+        {
+            return std::nullopt;
+        }
+    }
+
+    std::vector<int64> levelCounts(as_usize(varCount));
+    for (int64& count : levelCounts)
+    {
+        count = reader.read<int64>();
+    }
+    int32 const width = reader.read<int32>();
+    if (not reader.is_ok()
+        || (width != 1 && width != 2 && width != 4 && width != 8))
+    {
+        return std::nullopt;
+    }
+
+    // Check the size of the node table before creating any node.
+    int64 sonCount = 0;
+    for (int32 level = 0; level < varCount; ++level)
+    {
+        int64 const count  = levelCounts[as_uindex(level)];
+        int64 const domain = nodes_.get_domain(nodes_.get_index(level));
+        if (count < 0 || count > reader.get_remaining() / width)
+        {
+            return std::nullopt;
+        }
+        sonCount += count * domain;
+    }
+    if (sonCount > reader.get_remaining() / width)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<node_t*> idToNode;
+    idToNode.reserve(as_usize(terminalCount + sonCount));
+    for (int32 const value : terminalValues)
+    {
+        idToNode.push_back(nodes_.make_terminal_node(value));
+    }
+
+    // Created nodes stay marked unless they become a son, so they
+    // must be unmarked on every path that leaves them unused.
+    auto const reject = [this, &idToNode] ()
+    {
+        for (node_t* const node : idToNode)
+        {
+            id_set_notmarked(node);
+        }
+        nodes_.run_deferred();
+        return std::nullopt;
+    };
+
+    for (int32 level = varCount - 1; level >= 0; --level)
+    {
+        int32 const index   = nodes_.get_index(level);
+        int32 const domain  = nodes_.get_domain(index);
+        int64 const firstId = ssize(idToNode);
+        for (int64 i = 0; i < levelCounts[as_uindex(level)]; ++i)
+        {
+            son_container sons = nodes_.make_son_container(domain);
+            for (int32 k = 0; k < domain; ++k)
+            {
+                // Sons must be on lower levels. Ids read with width 8
+                // can be negative after the conversion.
+                auto const sonId = static_cast<int64>(reader.read(width));
+                if (sonId < 0 || sonId >= firstId)
+                {
+                    if constexpr (degrees::is_mixed<Degree>::value)
+                    {
+                        node_t::delete_son_container(sons);
+                    }
+                    return reject();
+                }
+                sons[k] = idToNode[as_uindex(sonId)];
+            }
+
+            // The unique table lookup also merges duplicate records
+            // that a corrupted file might contain.
+            idToNode.push_back(nodes_.make_internal_node(index, sons));
+        }
+    }
+
+    int64 const rootCount = reader.read<int64>();
+    if (not reader.is_ok() || rootCount < 0
+        || rootCount > reader.get_remaining() / width)
+    {
+        return reject();
+    }
+
+    std::vector<node_t*> roots;
+    roots.reserve(as_usize(rootCount));
+    for (int64 i = 0; i < rootCount; ++i)
+    {
+        auto const rootId = static_cast<int64>(reader.read(width));
+        if (rootId < 0 || rootId >= ssize(idToNode))
+        {
+            return reject();
+        }
+        roots.push_back(idToNode[as_uindex(rootId)]);
+    }
+
+    // Unused records would otherwise stay marked. Roots are owned
+    // by diagrams before deferred GC and reordering can run.
+    for (node_t* const node : idToNode)
+    {
+        id_set_notmarked(node);
+    }
+    std::vector<diagram_t> diagrams;
+    diagrams.reserve(as_usize(rootCount));
+    for (node_t* const root : roots)
+    {
+        diagrams.emplace_back(root);
+    }
+    nodes_.run_deferred();
+
+    return std::optional<std::vector<diagram_t>>(
+        static_cast<std::vector<diagram_t>&&>(diagrams)
+    );
+}
+
 template<class Data, class Degree, class Domain>
 auto diagram_manager<Data, Degree, Domain>::force_gc() -> void
 {
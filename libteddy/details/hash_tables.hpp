@@ -306,6 +306,11 @@ public:
      */
     auto remove_unused () -> void;
 
+    /**
+     *  \brief Removes entries of operations with id \p firstOpId or higher
+     */
+    auto remove_ops_from (int32 firstOpId) -> void;
+
     /**
      *  \brief Clears all entries
      */
@@ -813,6 +818,20 @@ auto apply_cache<Data, Degree>::remove_unused() -> void
     }
 }
 
+template<class Data, class Degree>
+auto apply_cache<Data, Degree>::remove_ops_from(int32 const firstOpId) -> void
+{
+    for (int64 i = 0; i < capacity_; ++i)
+    {
+        cache_entry& entry = entries_[i];
+        if (entry.result_ && entry.opId_ >= firstOpId)
+        {
+            entry = cache_entry {};
+            --size_;
+        }
+    }
+}
+
 template<class Data, class Degree>
 auto apply_cache<Data, Degree>::clear() -> void
 {
@@ -0,0 +1,236 @@
+#ifndef LIBTEDDY_DETAILS_MAPPED_FILE_HPP
+#define LIBTEDDY_DETAILS_MAPPED_FILE_HPP
+
+#include <libteddy/details/tools.hpp>
+#include <libteddy/details/types.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    define LIBTEDDY_HAS_MMAP
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#else
+#    include <fstream>
+#    include <vector>
+#endif
+
+namespace teddy
+{
+/**
+ *  \class mapped_file
+ *  \brief Read-only view of the content of a binary file
+ *
+ *  On POSIX systems the file is memory-mapped, so the content is loaded
+ *  lazily by the OS. On other systems the whole file is read into memory.
+ */
+class mapped_file
+{
+public:
+    /**
+     *  \brief Maps file at given path
+     *  \param path Path to the file
+     *  \return Optional holding instance of \c mapped_file or
+     *  \c std::nullopt if the file could not be opened
+     */
+    static auto load_file (std::string const& path)
+        -> std::optional<mapped_file>;
+
+public:
+    mapped_file(mapped_file const&) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+    ~mapped_file();
+
+    auto operator= (mapped_file const&) -> mapped_file& = delete;
+    auto operator= (mapped_file&& other) noexcept -> mapped_file&;
+
+    /**
+     *  \brief Returns pointer to the first byte of the file
+     *  \return Pointer to the content
+     */
+    [[nodiscard]] auto data () const -> std::byte const*;
+
+    /**
+     *  \brief Returns size of the file in bytes
+     *  \return Size of the file
+     */
+    [[nodiscard]] auto size () const -> int64;
+
+    /**
+     *  \brief Returns view of the content as an array of \p T
+     *
+     *  Trailing bytes that do not form a whole \p T are not part
+     *  of the view. Can be used e.g. as a truth vector:
+     *  \code
+     *  auto file = teddy::mapped_file::load_file("vector.bin");
+     *  auto f    = manager.from_vector(file->as_span<int8_t>());
+     *  \endcode
+     *
+     *  \tparam T Element type
+     *  \return Span of elements
+     */
+    template<class T>
+    [[nodiscard]] auto as_span () const -> std::span<T const>;
+
+private:
+#ifdef LIBTEDDY_HAS_MMAP
+    mapped_file(std::byte const* data, int64 size);
+#else
+    mapped_file(std::vector<std::byte> content);
+#endif
+
+private:
+#ifdef LIBTEDDY_HAS_MMAP
+    std::byte const* data_;
+    int64 size_;
+#else
+    std::vector<std::byte> content_;
+#endif
+};
+
+#ifdef LIBTEDDY_HAS_MMAP
+
+inline auto mapped_file::load_file(std::string const& path)
+    -> std::optional<mapped_file>
+{
+    int const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+
+    struct stat fileStat {};
+    if (::fstat(fd, &fileStat) != 0)
+    {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    auto const size = static_cast<int64>(fileStat.st_size);
+    if (0 == size)
+    {
+        ::close(fd);
+        return mapped_file(nullptr, 0);
+    }
+
+    void* const data = ::mmap(
+        nullptr,
+        static_cast<std::size_t>(size),
+        PROT_READ,
+        MAP_PRIVATE,
+        fd,
+        0
+    );
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        return std::nullopt;
+    }
+
+    return mapped_file(static_cast<std::byte const*>(data), size);
+}
+
+inline mapped_file::mapped_file(std::byte const* const data, int64 const size) :
+    data_(data),
+    size_(size)
+{
+}
+
+inline mapped_file::mapped_file(mapped_file&& other) noexcept :
+    data_(utils::exchange(other.data_, nullptr)),
+    size_(utils::exchange(other.size_, 0))
+{
+}
+
+inline mapped_file::~mapped_file()
+{
+    if (data_)
+    {
+        ::munmap(
+            const_cast<std::byte*>(data_),
+            static_cast<std::size_t>(size_)
+        );
+    }
+}
+
+inline auto mapped_file::operator= (mapped_file&& other) noexcept
+    -> mapped_file&
+{
+    utils::swap(data_, other.data_);
+    utils::swap(size_, other.size_);
+    return *this;
+}
+
+inline auto mapped_file::data() const -> std::byte const*
+{
+    return data_;
+}
+
+inline auto mapped_file::size() const -> int64
+{
+    return size_;
+}
+
+#else
+
+inline auto mapped_file::load_file(std::string const& path)
+    -> std::optional<mapped_file>
+{
+    auto ifst = std::ifstream(path, std::ios::binary | std::ios::ate);
+    if (not ifst.is_open())
+    {
+        return std::nullopt;
+    }
+
+    auto const size = static_cast<int64>(ifst.tellg());
+    auto content    = std::vector<std::byte>(as_usize(size));
+    ifst.seekg(0);
+    ifst.read(reinterpret_cast<char*>(content.data()), size);
+    if (not ifst)
+    {
+        return std::nullopt;
+    }
+
+    return mapped_file(static_cast<std::vector<std::byte>&&>(content));
+}
+
+inline mapped_file::mapped_file(std::vector<std::byte> content) :
+    content_(static_cast<std::vector<std::byte>&&>(content))
+{
+}
+
+inline mapped_file::mapped_file(mapped_file&& other) noexcept = default;
+
+inline mapped_file::~mapped_file() = default;
+
+inline auto mapped_file::operator= (mapped_file&& other) noexcept
+    -> mapped_file& = default;
+
+inline auto mapped_file::data() const -> std::byte const*
+{
+    return content_.data();
+}
+
+inline auto mapped_file::size() const -> int64
+{
+    return static_cast<int64>(content_.size());
+}
+
+#endif
+
+template<class T>
+auto mapped_file::as_span() const -> std::span<T const>
+{
+    return std::span<T const>(
+        reinterpret_cast<T const*>(this->data()),
+        as_usize(this->size() / static_cast<int64>(sizeof(T)))
+    );
+}
+} // namespace teddy
+
+#endif
@@ -13,8 +13,9 @@
 #include <cassert>
 #include <concepts>
 #include <cstdint>
+#include <functional>
 #include <ostream>
-#include <string>
+#include <stdexcept>
 #include <vector>
 
 namespace teddy
@@ -150,6 +151,13 @@ public:
 
     auto to_dot_graph (std::ostream& ost) const -> void;
     auto to_dot_graph (std::ostream& ost, node_t* node) const -> void;
+    auto to_dot_graph (
+        std::ostream& ost,
+        node_t* node,
+        int32 levelFrom,
+        int32 levelTo,
+        int64 maxNodeCount
+    ) const -> void;
 
     [[nodiscard]] auto domain_product (int32 levelFrom, int32 levelTo) const
         -> int64;
@@ -176,6 +184,31 @@ public:
     template<teddy_bin_op O>
     auto cache_put (node_t* result, node_t* lhs, node_t* rhs) -> void;
 
+    /**
+     *  \brief Returns a new id for an operation not known at compile time
+     *
+     *  Cached results of previously returned ids are never found using
+     *  the new id. Hence, taking a new id invalidates the results
+     *  of an operation in constant time.
+     */
+    [[nodiscard]] auto make_operation_id () -> int32;
+
+    /**
+     *  \brief Returns a new id for an operation not known at compile time
+     *
+     *  Unlike ids returned by \c make_operation_id , the id is never
+     *  reused and its results survive exhaustion of the other ids.
+     *  Persistent ids come from a separate range below the ids returned
+     *  by \c make_operation_id which limits their number.
+     */
+    [[nodiscard]] auto make_persistent_operation_id () -> int32;
+
+    [[nodiscard]] auto cache_find (int32 opId, node_t* lhs, node_t* rhs)
+        -> node_t*;
+
+    auto cache_put (int32 opId, node_t* result, node_t* lhs, node_t* rhs)
+        -> void;
+
     auto cache_clear () -> void;
 
     template<class NodeOp>
@@ -220,8 +253,18 @@ private:
     auto delete_node (node_t* node) -> void;
 
     template<class ForEachNode>
-    auto to_dot_graph_common (std::ostream& ost, ForEachNode&& forEach) const
-        -> void;
+    auto to_dot_graph_common (
+        std::ostream& ost,
+        ForEachNode&& forEach,
+        int32 levelFrom,
+        int32 levelTo,
+        int64 maxNodeCount
+    ) const -> void;
+    auto to_dot_graph_level (
+        std::ostream& ost,
+        std::vector<node_t*> const& nodes,
+        int64 firstId
+    ) const -> void;
 
     auto deferr_gc_reorder () -> void;
 
@@ -236,6 +279,8 @@ private:
     static constexpr int32 DEFAULT_FIRST_TABLE_ADJUSTMENT = 230;
     static constexpr double DEFAULT_CACHE_RATIO           = 1.0;
     static constexpr double DEFAULT_GC_RATIO              = 0.20;
+    static constexpr int32 FIRST_PERSISTENT_OP_ID         = 1'024;
+    static constexpr int32 FIRST_DYNAMIC_OP_ID            = 1'048'576;
 
 private:
     apply_cache<Data, Degree> opCache_;
@@ -251,6 +296,8 @@ private:
     int64 adjustmentNodeCount_;
     double cacheRatio_;
     double gcRatio_;
+    int32 nextOpId_;
+    int32 nextPersistentOpId_;
     bool autoReorderEnabled_;
     bool gcReorderDeferred_;
 };
@@ -344,6 +391,8 @@ node_manager<Data, Degree, Domain>::node_manager(
     adjustmentNodeCount_(DEFAULT_FIRST_TABLE_ADJUSTMENT),
     cacheRatio_(DEFAULT_CACHE_RATIO),
     gcRatio_(DEFAULT_GC_RATIO),
+    nextOpId_(FIRST_DYNAMIC_OP_ID),
+    nextPersistentOpId_(FIRST_DYNAMIC_OP_ID - 1),
     autoReorderEnabled_(false),
     gcReorderDeferred_(false)
 {
@@ -691,7 +740,10 @@ auto node_manager<Data, Degree, Domain>::to_dot_graph(std::ostream& ost) const
 {
     this->to_dot_graph_common(
         ost,
-        [this] (auto const& operation) { this->for_each_node(operation); }
+        [this] (auto const& operation) { this->for_each_node(operation); },
+        0,
+        this->get_leaf_level() + 1,
+        INT64_MAX
     );
 }
 
@@ -700,11 +752,25 @@ auto node_manager<Data, Degree, Domain>::to_dot_graph(
     std::ostream& ost,
     node_t* const node
 ) const -> void
+{
+    this->to_dot_graph(ost, node, 0, this->get_leaf_level() + 1, INT64_MAX);
+}
+
+template<class Data, class Degree, class Domain>
+auto node_manager<Data, Degree, Domain>::to_dot_graph(
+    std::ostream& ost,
+    node_t* const node,
+    int32 const levelFrom,
+    int32 const levelTo,
+    int64 const maxNodeCount
+) const -> void
 {
     this->to_dot_graph_common(
         ost,
-        [this, node] (auto const& operation)
-        { this->traverse_pre(node, operation); }
+        [node] (auto const& operation) { operation(node); },
+        levelFrom,
+        levelTo,
+        maxNodeCount
     );
 }
 
@@ -830,6 +896,59 @@ auto node_manager<Data, Degree, Domain>::cache_put(
     opCache_.put(O::get_id(), result, lhs, rhs);
 }
 
+template<class Data, class Degree, class Domain>
+auto node_manager<Data, Degree, Domain>::make_operation_id() -> int32
+{
+    if (nextOpId_ == Undefined)
+    {
+        // Ids are exhausted, old results must be removed before reuse.
+        // Results of static and persistent operations are kept.
+        opCache_.remove_ops_from(FIRST_DYNAMIC_OP_ID);
+        nextOpId_ = FIRST_DYNAMIC_OP_ID;
+    }
+    return nextOpId_++;
+}
+
+template<class Data, class Degree, class Domain>
+auto node_manager<Data, Degree, Domain>::make_persistent_operation_id()
+    -> int32
+{
+    // Persistent ids are taken downwards so that the ranges
+    // of static, persistent, and dynamic ids never overlap.
+    // Ids are never reused since their owners may still be alive.
+    if (nextPersistentOpId_ < FIRST_PERSISTENT_OP_ID)
+    {
+        throw std::runtime_error("Persistent operation ids are exhausted.");
+    }
+    return nextPersistentOpId_--;
+}
+
+template<class Data, class Degree, class Domain>
+auto node_manager<Data, Degree, Domain>::cache_find(
+    int32 const opId,
+    node_t* const lhs,
+    node_t* const rhs
+) -> node_t*
+{
+    node_t* const node = opCache_.find(opId, lhs, rhs);
+    if (node)
+    {
+        id_set_marked(node);
+    }
+    return node;
+}
+
+template<class Data, class Degree, class Domain>
+auto node_manager<Data, Degree, Domain>::cache_put(
+    int32 const opId,
+    node_t* const result,
+    node_t* const lhs,
+    node_t* const rhs
+) -> void
+{
+    opCache_.put(opId, result, lhs, rhs);
+}
+
 template<class Data, class Degree, class Domain>
 auto node_manager<Data, Degree, Domain>::cache_clear() -> void
 {
@@ -1083,118 +1202,203 @@ template<class Data, class Degree, class Domain>
 template<class ForEachNode>
 auto node_manager<Data, Degree, Domain>::to_dot_graph_common(
     std::ostream& ost,
-    ForEachNode&& forEach
+    ForEachNode&& forEach,
+    int32 const levelFrom,
+    int32 const levelTo,
+    int64 const maxNodeCount
 ) const -> void
 {
-    auto const make_label = [] (node_t* const node)
+    // Nodes are discovered level by level starting from the nodes given
+    // by forEach. Levels below the window are not entered and discovery
+    // stops once the limit is reached. Marks serve as the visited flag.
+    int64 const nodeLimit  = utils::max(maxNodeCount, int64 {0});
+    int32 const firstLevel = utils::max(levelFrom, 0);
+    int32 const lastLevel  = utils::min(levelTo, this->get_leaf_level() + 1);
+    std::vector<std::vector<node_t*>> buckets(
+        as_usize(utils::max(lastLevel, 0))
+    );
+    forEach(
+        [&, this] (node_t* const node)
+        {
+            int32 const level = this->get_level(node);
+            if (level < lastLevel && not node->is_marked())
+            {
+                node->set_marked();
+                buckets[as_uindex(level)].push_back(node);
+            }
+        }
+    );
+
+    // Printed nodes of each level are sorted by address. Id of a printed
+    // node is the id of the first node on its level plus its position.
+    std::vector<std::vector<node_t*>> printed(buckets.size());
+    std::vector<int64> firstIds(buckets.size(), 0);
+    int64 nodeCount = 0;
+
+    ost << "digraph DD {\n";
+    ost << "    node [shape = circle];\n";
+    for (int32 level = 0; level < lastLevel && nodeCount < nodeLimit; ++level)
     {
-        if (node->is_terminal())
+        std::vector<node_t*> const& discovered = buckets[as_uindex(level)];
+        int64 expandCount                      = ssize(discovered);
+        if (level >= firstLevel)
         {
-            using namespace std::literals::string_literals;
-            int32 const val = node->get_value();
-            return val == Undefined ? "*"s : std::to_string(val);
+            expandCount = utils::min(expandCount, nodeLimit - nodeCount);
+            std::vector<node_t*>& nodes = printed[as_uindex(level)];
+            nodes.assign(begin(discovered), begin(discovered) + expandCount);
+            utils::sort(nodes, std::less<node_t*>());
+            firstIds[as_uindex(level)] = nodeCount;
+            nodeCount += expandCount;
+            this->to_dot_graph_level(ost, nodes, firstIds[as_uindex(level)]);
         }
 
-        return "x" + std::to_string(node->get_index());
-    };
+        for (int64 i = 0; i < expandCount; ++i)
+        {
+            node_t* const node = discovered[as_uindex(i)];
+            if (node->is_terminal())
+            {
+                continue;
+            }
 
-    auto const get_id_str = [] (node_t* const n)
-    { return std::to_string(reinterpret_cast<uint64>(n)); };
+            this->for_each_son(
+                node,
+                [&, this] (node_t* const son)
+                {
+                    int32 const sonLevel = this->get_level(son);
+                    if (sonLevel < lastLevel && not son->is_marked())
+                    {
+                        son->set_marked();
+                        buckets[as_uindex(sonLevel)].push_back(son);
+                    }
+                }
+            );
+        }
+    }
 
-    auto const output_range = [] (auto& ostr, auto const& range, auto const sep)
+    auto const find_id = [&, this] (node_t* const node) -> int64
     {
-        auto const endIt = end(range);
-        auto rangeIt     = begin(range);
-        while (rangeIt != endIt)
+        int32 const level = this->get_level(node);
+        if (level < firstLevel || level >= lastLevel)
         {
-            ostr << *rangeIt;
-            ++rangeIt;
-            if (rangeIt != endIt)
+            return -1;
+        }
+
+        std::vector<node_t*> const& nodes = printed[as_uindex(level)];
+        int64 low                         = 0;
+        int64 high                        = ssize(nodes);
+        while (low < high)
+        {
+            int64 const mid = low + (high - low) / 2;
+            if (std::less<node_t*>()(nodes[as_uindex(mid)], node))
+            {
+                low = mid + 1;
+            }
+            else
             {
-                ostr << sep;
+                high = mid;
             }
         }
+        return low < ssize(nodes) && nodes[as_uindex(low)] == node
+                 ? firstIds[as_uindex(level)] + low
+                 : -1;
     };
 
-    auto const levelCount = as_usize(1 + this->get_var_count());
-    std::vector<std::string> labels;
-    std::vector<std::vector<std::string>> rankGroups(levelCount);
-    std::vector<std::string> arcs;
-    std::vector<std::string> squareShapes;
-
-    forEach(
-        [&, this] (node_t* const node)
+    bool hasCut = false;
+    for (int32 level = firstLevel; level < lastLevel; ++level)
+    {
+        std::vector<node_t*> const& nodes = printed[as_uindex(level)];
+        for (int64 i = 0; i < ssize(nodes); ++i)
         {
-            // Create label.
-            int32 const level = this->get_level(node);
-            labels.emplace_back(
-                get_id_str(node) + R"( [label = ")" + make_label(node)
-                + R"(", tooltip = ")" + std::to_string(node->get_ref_count())
-                + R"("];)"
-            );
-
+            node_t* const node = nodes[as_uindex(i)];
             if (node->is_terminal())
             {
-                squareShapes.emplace_back(get_id_str(node));
-                rankGroups.back().emplace_back(get_id_str(node) + ";");
-                return;
+                continue;
             }
 
-            // Add to same level.
-            rankGroups[as_uindex(level)].emplace_back(get_id_str(node) + ";");
-
-            // Add arcs.
+            int64 const id = firstIds[as_uindex(level)] + i;
             this->for_each_son(
                 node,
                 [&, sonOrder = 0] (node_t* const son) mutable
                 {
+                    ost << "    " << id << " -> ";
+                    int64 const sonId = find_id(son);
+                    if (sonId == -1)
+                    {
+                        ost << "cut";
+                        hasCut = true;
+                    }
+                    else
+                    {
+                        ost << sonId;
+                    }
+
                     if constexpr (std::is_same_v<Degree, degrees::fixed<2>>)
                     {
-                        arcs.emplace_back(
-                            get_id_str(node) + " -> " + get_id_str(son)
-                            + " [style = "
-                            + (0 == sonOrder ? "dashed" : "solid") + "];"
-                        );
+                        ost << " [style = "
+                            << (0 == sonOrder ? "dashed" : "solid") << "];\n";
                     }
                     else
                     {
-                        arcs.emplace_back(
-                            get_id_str(node) + " -> " + get_id_str(son)
-                            + R"( [label = )" + std::to_string(sonOrder) + "];"
-                        );
+                        ost << " [label = " << sonOrder << "];\n";
                     }
                     ++sonOrder;
                 }
             );
         }
-    );
+    }
 
-    // Finally, output everything into the output stream.
-    ost << "digraph DD {" << '\n';
-    ost << "    node [shape = square] ";
-    output_range(ost, squareShapes, " ");
-    ost << ";\n";
-    ost << "    node [shape = circle];"
-        << "\n\n";
+    if (hasCut)
+    {
+        ost << "\n    cut [label = \"...\", shape = plaintext];\n";
+    }
+    ost << "}\n";
 
-    ost << "    ";
-    output_range(ost, labels, "\n    ");
-    ost << "\n\n";
-    ost << "    ";
-    output_range(ost, arcs, "\n    ");
-    ost << "\n\n";
+    for (std::vector<node_t*> const& discovered : buckets)
+    {
+        for (node_t* const node : discovered)
+        {
+            node->set_notmarked();
+        }
+    }
+}
+
+template<class Data, class Degree, class Domain>
+auto node_manager<Data, Degree, Domain>::to_dot_graph_level(
+    std::ostream& ost,
+    std::vector<node_t*> const& nodes,
+    int64 const firstId
+) const -> void
+{
+    if (nodes.empty())
+    {
+        return;
+    }
 
-    for (std::vector<std::string> const& ranks : rankGroups)
+    ost << "\n    {\n        rank = same;\n";
+    for (int64 i = 0; i < ssize(nodes); ++i)
     {
-        if (not ranks.empty())
+        node_t* const node = nodes[as_uindex(i)];
+        ost << "        " << firstId + i << " [label = \"";
+        if (node->is_terminal())
+        {
+            int32 const value = node->get_value();
+            if (value == Undefined)
+            {
+                ost << "*";
+            }
+            else
+            {
+                ost << value;
+            }
+            ost << "\", shape = square";
+        }
+        else
         {
-            ost << "    { rank = same; ";
-            output_range(ost, ranks, " ");
-            ost << " }" << '\n';
+            ost << "x" << node->get_index() << "\"";
         }
+        ost << ", tooltip = \"" << node->get_ref_count() << "\"];\n";
     }
-    ost << '\n';
-    ost << "}" << '\n';
+    ost << "    }\n";
 }
 
 template<class Data, class Degree, class Domain>
@@ -289,6 +289,69 @@ struct IMPLIES : details::operation_info<19, false>
 };
 } // namespace ops
 
+namespace details
+{
+/**
+ *  \brief Tells whether the operation is associative
+ *
+ *  Operations that merge multiple values (e.g. in \c abstract ) can
+ *  only be used if the order of merging does not matter.
+ */
+template<class Operation>
+struct is_associative
+{
+    static constexpr bool value = false;
+};
+
+template<>
+struct is_associative<ops::AND>
+{
+    static constexpr bool value = true;
+};
+
+template<>
+struct is_associative<ops::OR>
+{
+    static constexpr bool value = true;
+};
+
+template<>
+struct is_associative<ops::XOR>
+{
+    static constexpr bool value = true;
+};
+
+template<>
+struct is_associative<ops::MIN>
+{
+    static constexpr bool value = true;
+};
+
+template<>
+struct is_associative<ops::MAX>
+{
+    static constexpr bool value = true;
+};
+
+template<int32 M>
+struct is_associative<ops::MAXB<M>>
+{
+    static constexpr bool value = true;
+};
+
+template<int32 M>
+struct is_associative<ops::PLUS<M>>
+{
+    static constexpr bool value = true;
+};
+
+template<int32 M>
+struct is_associative<ops::MULTIPLIES<M>>
+{
+    static constexpr bool value = true;
+};
+} // namespace details
+
 template<class Operation>
 concept teddy_bin_op = requires() {
                            {
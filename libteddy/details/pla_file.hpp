@@ -2,16 +2,15 @@
 #define LIBTEDDY_DETAILS_PLA_FILE_HPP
 
 #include <libteddy/details/debug.hpp>
+#include <libteddy/details/pla_stream.hpp>
 #include <libteddy/details/tools.hpp>
 #include <libteddy/details/types.hpp>
 
 #include <cassert>
-#include <cctype>
 #include <cstdint>
-#include <fstream>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 namespace teddy
@@ -208,200 +207,64 @@ inline auto bool_cube::set(int32 const index, int32 const value) -> void
 inline auto pla_file::load_file(std::string const& path)
     -> std::optional<pla_file>
 {
-    auto constexpr to_words = [] (std::string const& str)
-    {
-        std::vector<std::string> words;
-        auto strIt       = str.begin();
-        auto const endIt = str.end();
-
-        while (strIt != endIt)
-        {
-            auto const wordBegin = utils::find_if_not(strIt, endIt, ::isspace);
-            auto const wordEnd   = utils::find_if(wordBegin, endIt, ::isspace);
-            if (wordBegin != wordEnd)
-            {
-                words.emplace_back(wordBegin, wordEnd);
-            }
-            strIt = wordEnd;
-        }
-
-        return words;
-    };
-
-    auto ifst = std::ifstream(path);
-    if (not ifst.is_open())
+    std::optional<pla_stream> stream = pla_stream::open_file(path);
+    if (not stream || not stream->get_declared_line_count())
     {
         return std::nullopt;
     }
 
-    // Read options.
-    auto options = std::unordered_map<std::string, std::string>();
-    auto line    = std::string();
-    while (std::getline(ifst, line))
-    {
-        // Skip leading spaces.
-        auto const first
-            = utils::find_if_not(line.begin(), line.end(), ::isspace);
-        auto const last = line.end();
-        if (first == last)
-        {
-            // Skip empty line.
-            continue;
-        }
-
-        if (*first == '#')
-        {
-            // Skip comment.
-            continue;
-        }
-
-        if (*first != '.')
-        {
-            // Not an option.
-            break;
-        }
-
-        // Split into (key, val) pair on the first space.
-        auto const keyLast = utils::find_if(first, last, ::isspace);
-        auto const valFirst
-            = keyLast == last
-                ? last
-                : utils::find_if_not(keyLast + 1, last, ::isspace);
-        std::string key(first, keyLast);
-        if (valFirst != last)
-        {
-            auto valLast = last;
-            while (::isspace(*(valLast - 1)))
-            {
-                --valLast;
-            }
-            std::string val(valFirst, valLast);
-            options.emplace(
-                static_cast<std::string&&>(key),
-                static_cast<std::string&&>(val)
-            );
-        }
-        else
-        {
-            options.emplace(static_cast<std::string&&>(key), std::string());
-        }
-    }
-
-    // Parse header.
-    auto const optionsEnd  = options.end();
-    auto const varCountIt  = options.find(".i");
-    auto const fCountIt    = options.find(".o");
-    auto const lineCountIt = options.find(".p");
-    if (varCountIt == optionsEnd || fCountIt == optionsEnd
-        || lineCountIt == optionsEnd)
-    {
-        return std::nullopt;
-    }
-
-    std::optional<int32> varCount  = utils::parse<int32>(varCountIt->second);
-    std::optional<int32> fCount    = utils::parse<int32>(fCountIt->second);
-    std::optional<int32> lineCount = utils::parse<int64>(lineCountIt->second);
-
-    if (not varCount || not fCount || not lineCount)
-    {
-        return std::nullopt;
-    }
+    int32 const varCount = stream->get_variable_count();
+    int32 const fCount   = stream->get_function_count();
+    packed_cubes inputs(varCount);
+    packed_cubes outputs(fCount);
 
     // Read data.
+    int64 constexpr BlockSize = 4'096;
     std::vector<pla_file::pla_line> lines;
-    lines.reserve(as_usize(*lineCount));
-    do
+    lines.reserve(as_usize(*stream->get_declared_line_count()));
+    for (;;)
     {
-        auto const first
-            = utils::find_if_not(line.begin(), line.end(), ::isspace);
-        auto const last = line.end();
-        if (first == last)
-        {
-            // Skip empty line.
-            continue;
-        }
-
-        if (*first == '.')
-        {
-            // This can only be the .e line.
-            break;
-        }
-
-        // Split on the first space.
-        auto const varsLast = utils::find_if(first, last, ::isspace);
-        if (varsLast == last)
+        std::optional<int64> const count
+            = stream->read_lines(inputs, outputs, BlockSize);
+        if (not count)
         {
             return std::nullopt;
         }
-        auto const fsFirst = utils::find_if_not(varsLast + 1, last, ::isspace);
-        auto const fsLast  = utils::find_if(fsFirst, last, ::isspace);
-        std::string const varsStr(first, varsLast);
-        std::string const fStr(fsFirst, fsLast);
 
-        if (ssize(varsStr) != *varCount || ssize(fStr) != *fCount)
+        if (0 == *count)
         {
-            return std::nullopt;
+            break;
         }
 
-        // Parse variables into cube.
-        bool_cube variables(*varCount);
-        for (auto i = 0; i < *varCount; ++i)
+        for (int64 li = 0; li < *count; ++li)
         {
-            switch (varsStr[as_uindex(i)])
+            bool_cube variables(varCount);
+            for (int32 i = 0; i < varCount; ++i)
             {
-            case '0':
-                variables.set(i, 0);
-                break;
-            case '1':
-                variables.set(i, 1);
-                break;
-            case '~':
-            case '-':
-                variables.set(i, bool_cube::DontCare);
-                break;
-            default:
-                return std::nullopt;
+                variables.set(i, inputs.get(li, i));
             }
-        }
 
-        // Parse functions into cube.
-        bool_cube functions(*fCount);
-        for (auto i = 0; i < *fCount; ++i)
-        {
-            switch (fStr[as_uindex(i)])
+            bool_cube functions(fCount);
+            for (int32 i = 0; i < fCount; ++i)
             {
-            case '0':
-                functions.set(i, 0);
-                break;
-            case '1':
-                functions.set(i, 1);
-                break;
-            case '-':
-            case '~':
-                functions.set(i, bool_cube::DontCare);
-                break;
-            default:
-                return std::nullopt;
+                functions.set(i, outputs.get(li, i));
             }
-        }
 
-        lines.push_back(pla_file::pla_line {variables, functions});
-
-    } while (std::getline(ifst, line));
+            lines.push_back(pla_file::pla_line {variables, functions});
+        }
+    }
 
     // Read labels.
-    auto const inLbIt = options.find(".ilb");
-    auto const ouLbIt = options.find(".ob");
     std::vector<std::string> inputLabels;
-    if (inLbIt != options.end())
+    for (std::string_view const label : stream->get_input_labels())
     {
-        inputLabels = to_words(inLbIt->second);
+        inputLabels.emplace_back(label);
     }
 
     std::vector<std::string> outputLabels;
-    if (ouLbIt != options.end())
+    for (std::string_view const label : stream->get_output_labels())
     {
-        outputLabels = to_words(ouLbIt->second);
+        outputLabels.emplace_back(label);
     }
 
     return pla_file(
@@ -0,0 +1,526 @@
+#ifndef LIBTEDDY_DETAILS_PLA_STREAM_HPP
+#define LIBTEDDY_DETAILS_PLA_STREAM_HPP
+
+#include <libteddy/details/mapped_file.hpp>
+#include <libteddy/details/tools.hpp>
+#include <libteddy/details/types.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace teddy
+{
+/**
+ *  \brief Contiguous buffer of cubes.
+ *
+ *  Each value of a cube is packed into 2 bits, 32 values per word.
+ *  Each cube occupies the same number of words (stride) so that
+ *  the whole buffer is a single allocation.
+ */
+class packed_cubes
+{
+public:
+    static constexpr int32 DontCare = 0b11;
+
+public:
+    /**
+     *  \brief Initializes empty buffer
+     *  \param size Number of values in each cube
+     */
+    explicit packed_cubes(int32 size);
+
+    /**
+     *  \brief Returns number of values in each cube
+     *  \return Size of a cube
+     */
+    [[nodiscard]] auto size () const -> int32;
+
+    /**
+     *  \brief Returns number of cubes in the buffer
+     *  \return Number of cubes
+     */
+    [[nodiscard]] auto get_count () const -> int64;
+
+    /**
+     *  \brief Returns i-th value of a cube
+     *  \param cube Index of the cube
+     *  \param i Index of the value
+     *  \return 0, 1, or \c DontCare
+     */
+    [[nodiscard]] auto get (int64 cube, int32 i) const -> int32;
+
+    /**
+     *  \brief Sets i-th value of a cube
+     *  \param cube Index of the cube
+     *  \param i Index of the value
+     *  \param value 0, 1, or \c DontCare
+     */
+    auto set (int64 cube, int32 i, int32 value) -> void;
+
+    /**
+     *  \brief Appends new cube with all values set to 0
+     *  \return Index of the new cube
+     */
+    auto push_back () -> int64;
+
+    /**
+     *  \brief Removes all cubes, keeps the allocated memory
+     */
+    auto clear () -> void;
+
+private:
+    static constexpr int32 ValuesPerWord = 32;
+
+private:
+    int32 size_;
+    int64 stride_;
+    int64 count_;
+    std::vector<uint64> words_;
+};
+
+/**
+ *  \brief Streaming reader of a PLA file.
+ *
+ *  The file is memory-mapped and tokenized in place. Header is parsed
+ *  when the file is opened, lines with cubes are then read in blocks
+ *  into \c packed_cubes so that the whole file never needs to be
+ *  materialized.
+ */
+class pla_stream
+{
+public:
+    /**
+     *  \brief Opens PLA file at given path and parses its header
+     *  \param path Path to the file
+     *  \return Optional holding instance of \c pla_stream or
+     *  \c std::nullopt if the file could not be opened or if the header
+     *  does not contain .i and .o options
+     */
+    static auto open_file (std::string const& path)
+        -> std::optional<pla_stream>;
+
+public:
+    /**
+     *  \brief Returns number of variables in the file
+     *  \return Number of variables
+     */
+    [[nodiscard]] auto get_variable_count () const -> int32;
+
+    /**
+     *  \brief Returns number of functions in the file
+     *  \return Number of functions
+     */
+    [[nodiscard]] auto get_function_count () const -> int32;
+
+    /**
+     *  \brief Returns number of lines declared by the .p option
+     *  \return Number of lines or \c std::nullopt if the option is missing
+     */
+    [[nodiscard]] auto get_declared_line_count () const
+        -> std::optional<int64>;
+
+    /**
+     *  \brief Returns labels of input variables
+     *  \return Views into the file
+     */
+    [[nodiscard]] auto get_input_labels () const
+        -> std::vector<std::string_view> const&;
+
+    /**
+     *  \brief Returns labels of functions
+     *  \return Views into the file
+     */
+    [[nodiscard]] auto get_output_labels () const
+        -> std::vector<std::string_view> const&;
+
+    /**
+     *  \brief Reads next block of lines
+     *
+     *  Both buffers are cleared first. Cube of i-th read line is stored
+     *  as i-th cube of \p inputs and values of functions as i-th cube
+     *  of \p outputs .
+     *
+     *  \param inputs Buffer for input cubes
+     *  \param outputs Buffer for values of functions
+     *  \param maxCount Maximal number of lines to read
+     *  \return Number of lines read (0 at the end of the file) or
+     *  \c std::nullopt if a line is malformed
+     */
+    auto read_lines (
+        packed_cubes& inputs,
+        packed_cubes& outputs,
+        int64 maxCount
+    ) -> std::optional<int64>;
+
+private:
+    pla_stream(mapped_file file);
+
+    auto parse_header () -> bool;
+
+    auto next_line () -> std::string_view;
+
+    static auto parse_cube (
+        std::string_view token,
+        packed_cubes& cubes,
+        int64 cube
+    ) -> bool;
+
+    static auto to_words (std::string_view str)
+        -> std::vector<std::string_view>;
+
+    static auto is_space (char c) -> bool;
+
+private:
+    mapped_file file_;
+    char const* current_;
+    char const* last_;
+    std::string_view pendingLine_;
+    int32 varCount_;
+    int32 fCount_;
+    std::optional<int64> lineCount_;
+    std::vector<std::string_view> inputLabels_;
+    std::vector<std::string_view> outputLabels_;
+};
+
+// packed_cubes definitions:
+
+inline packed_cubes::packed_cubes(int32 const size) :
+    size_(size),
+    stride_((size + ValuesPerWord - 1) / ValuesPerWord),
+    count_(0),
+    words_()
+{
+}
+
+inline auto packed_cubes::size() const -> int32
+{
+    return size_;
+}
+
+inline auto packed_cubes::get_count() const -> int64
+{
+    return count_;
+}
+
+inline auto packed_cubes::get(int64 const cube, int32 const i) const -> int32
+{
+    assert(cube >= 0 && cube < count_);
+    assert(i >= 0 && i < size_);
+    uint64 const word = words_[as_uindex(cube * stride_ + i / ValuesPerWord)];
+    return static_cast<int32>((word >> (2 * (i % ValuesPerWord))) & 0b11);
+}
+
+inline auto packed_cubes::set(
+    int64 const cube,
+    int32 const i,
+    int32 const value
+) -> void
+{
+    assert(cube >= 0 && cube < count_);
+    assert(i >= 0 && i < size_);
+    assert(value == 0 || value == 1 || value == DontCare);
+    uint64& word = words_[as_uindex(cube * stride_ + i / ValuesPerWord)];
+    int32 const shift = 2 * (i % ValuesPerWord);
+    word = (word & ~(uint64 {0b11} << shift))
+         | (static_cast<uint64>(value) << shift);
+}
+
+inline auto packed_cubes::push_back() -> int64
+{
+    words_.resize(words_.size() + as_usize(stride_), 0);
+    return count_++;
+}
+
+inline auto packed_cubes::clear() -> void
+{
+    words_.clear();
+    count_ = 0;
+}
+
+// pla_stream definitions:
+
+inline auto pla_stream::open_file(std::string const& path)
+    -> std::optional<pla_stream>
+{
+    std::optional<mapped_file> file = mapped_file::load_file(path);
+    if (not file)
+    {
+        return std::nullopt;
+    }
+
+    pla_stream stream(static_cast<mapped_file&&>(*file));
+    if (not stream.parse_header())
+    {
+        return std::nullopt;
+    }
+
+    return std::optional<pla_stream>(static_cast<pla_stream&&>(stream));
+}
+
+inline pla_stream::pla_stream(mapped_file file) :
+    file_(static_cast<mapped_file&&>(file)),
+    current_(reinterpret_cast<char const*>(file_.data())),
+    last_(current_ + file_.size()),
+    pendingLine_(),
+    varCount_(0),
+    fCount_(0),
+    lineCount_(std::nullopt),
+    inputLabels_(),
+    outputLabels_()
+{
+}
+
+inline auto pla_stream::get_variable_count() const -> int32
+{
+    return varCount_;
+}
+
+inline auto pla_stream::get_function_count() const -> int32
+{
+    return fCount_;
+}
+
+inline auto pla_stream::get_declared_line_count() const -> std::optional<int64>
+{
+    return lineCount_;
+}
+
+inline auto pla_stream::get_input_labels() const
+    -> std::vector<std::string_view> const&
+{
+    return inputLabels_;
+}
+
+inline auto pla_stream::get_output_labels() const
+    -> std::vector<std::string_view> const&
+{
+    return outputLabels_;
+}
+
+inline auto pla_stream::read_lines(
+    packed_cubes& inputs,
+    packed_cubes& outputs,
+    int64 const maxCount
+) -> std::optional<int64>
+{
+    assert(inputs.size() == varCount_);
+    assert(outputs.size() == fCount_);
+
+    inputs.clear();
+    outputs.clear();
+
+    int64 count = 0;
+    while (count < maxCount)
+    {
+        std::string_view line = pendingLine_.empty() ? this->next_line()
+                                                     : pendingLine_;
+        pendingLine_          = std::string_view();
+        if (line.data() == nullptr)
+        {
+            // End of the file.
+            break;
+        }
+
+        auto first = line.begin();
+        auto last  = line.end();
+        while (first != last && is_space(*first))
+        {
+            ++first;
+        }
+
+        if (first == last || *first == '#')
+        {
+            // Skip empty line or comment.
+            continue;
+        }
+
+        if (*first == '.')
+        {
+            // This can only be the .e line.
+            current_ = last_;
+            break;
+        }
+
+        // Split on the first space.
+        auto const varsLast = utils::find_if(first, last, is_space);
+        if (varsLast == last)
+        {
+            return std::nullopt;
+        }
+        auto const fsFirst = utils::find_if_not(varsLast, last, is_space);
+        auto const fsLast  = utils::find_if(fsFirst, last, is_space);
+
+        int64 const cube = inputs.push_back();
+        outputs.push_back();
+        bool const isValid
+            = parse_cube(std::string_view(first, varsLast), inputs, cube)
+           && parse_cube(std::string_view(fsFirst, fsLast), outputs, cube);
+        if (not isValid)
+        {
+            return std::nullopt;
+        }
+
+        ++count;
+    }
+
+    return count;
+}
+
+inline auto pla_stream::parse_header() -> bool
+{
+    std::string_view inputLabels;
+    std::string_view outputLabels;
+    bool hasVarCount = false;
+    bool hasFCount   = false;
+
+    for (;;)
+    {
+        std::string_view const line = this->next_line();
+        if (line.data() == nullptr)
+        {
+            break;
+        }
+
+        auto first = line.begin();
+        auto last  = line.end();
+        while (first != last && is_space(*first))
+        {
+            ++first;
+        }
+        while (first != last && is_space(*(last - 1)))
+        {
+            --last;
+        }
+
+        if (first == last || *first == '#')
+        {
+            // Skip empty line or comment.
+            continue;
+        }
+
+        if (*first != '.')
+        {
+            // Not an option, first line with a cube.
+            pendingLine_ = line;
+            break;
+        }
+
+        // Split into (key, val) pair on the first space.
+        auto const keyLast  = utils::find_if(first, last, is_space);
+        auto const valFirst = utils::find_if_not(keyLast, last, is_space);
+        auto const key      = std::string_view(first, keyLast);
+        auto const val      = std::string_view(valFirst, last);
+
+        if (key == ".i")
+        {
+            std::optional<int32> const varCount = utils::parse<int32>(val);
+            hasVarCount = varCount.has_value() && *varCount >= 0;
+            varCount_   = hasVarCount ? *varCount : 0;
+        }
+        else if (key == ".o")
+        {
+            std::optional<int32> const fCount = utils::parse<int32>(val);
+            hasFCount = fCount.has_value() && *fCount >= 0;
+            fCount_   = hasFCount ? *fCount : 0;
+        }
+        else if (key == ".p")
+        {
+            lineCount_ = utils::parse<int64>(val);
+        }
+        else if (key == ".ilb")
+        {
+            inputLabels = val;
+        }
+        else if (key == ".ob")
+        {
+            outputLabels = val;
+        }
+    }
+
+    inputLabels_  = to_words(inputLabels);
+    outputLabels_ = to_words(outputLabels);
+    return hasVarCount && hasFCount;
+}
+
+inline auto pla_stream::next_line() -> std::string_view
+{
+    if (current_ == last_)
+    {
+        return std::string_view();
+    }
+
+    char const* const lineFirst = current_;
+    char const* lineLast        = lineFirst;
+    while (lineLast != last_ && *lineLast != '\n')
+    {
+        ++lineLast;
+    }
+    current_ = lineLast == last_ ? last_ : lineLast + 1;
+
+    // Data pointer of an empty line must not be null, null marks the end.
+    return std::string_view(lineFirst, as_usize(lineLast - lineFirst));
+}
+
+inline auto pla_stream::parse_cube(
+    std::string_view const token,
+    packed_cubes& cubes,
+    int64 const cube
+) -> bool
+{
+    if (ssize(token) != cubes.size())
+    {
+        return false;
+    }
+
+    for (int32 i = 0; i < cubes.size(); ++i)
+    {
+        switch (token[as_uindex(i)])
+        {
+        case '0':
+            break;
+        case '1':
+            cubes.set(cube, i, 1);
+            break;
+        case '~':
+        case '-':
+            cubes.set(cube, i, packed_cubes::DontCare);
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+inline auto pla_stream::is_space(char const c) -> bool
+{
+    // Same as std::isspace in the "C" locale.
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v'
+        || c == '\f';
+}
+
+inline auto pla_stream::to_words(std::string_view const str)
+    -> std::vector<std::string_view>
+{
+    std::vector<std::string_view> words;
+    auto strIt       = str.begin();
+    auto const endIt = str.end();
+    while (strIt != endIt)
+    {
+        auto const wordBegin = utils::find_if_not(strIt, endIt, is_space);
+        auto const wordEnd   = utils::find_if(wordBegin, endIt, is_space);
+        if (wordBegin != wordEnd)
+        {
+            words.emplace_back(wordBegin, wordEnd);
+        }
+        strIt = wordEnd;
+    }
+    return words;
+}
+} // namespace teddy
+
+#endif
@@ -131,6 +131,11 @@ auto expr_node::evaluate(int32 const l, int32 const r) const -> int32
     }
 }
 
+auto expr_node::get_operation_id() const -> int32
+{
+    return static_cast<int32>(std::get<operation_t>(data_).op_);
+}
+
 auto expr_node::get_left() const -> expr_node const&
 {
     return *std::get<operation_t>(data_).l_;
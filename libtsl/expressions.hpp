@@ -118,6 +118,8 @@ public:
 
     auto evaluate (int32 l, int32 r) const -> int32;
 
+    auto get_operation_id () const -> int32;
+
     auto get_left () const -> expr_node const&;
 
     auto get_right () const -> expr_node const&;
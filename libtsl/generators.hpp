@@ -20,18 +20,10 @@ auto make_diagram (
 )
 {
     auto const min_fold = [&manager, foldtype] (auto& diagrams)
-    {
-        return foldtype == fold_type::Left
-                 ? manager.template left_fold<ops::MIN>(diagrams)
-                 : manager.template tree_fold<ops::MIN>(diagrams);
-    };
+    { return manager.template fold<ops::MIN>(diagrams, foldtype); };
 
     auto const max_fold = [&manager, foldtype] (auto& diagrams)
-    {
-        return foldtype == fold_type::Left
-                 ? manager.template left_fold<ops::MAX>(diagrams)
-                 : manager.template tree_fold<ops::MAX>(diagrams);
-    };
+    { return manager.template fold<ops::MAX>(diagrams, foldtype); };
 
     using diagram_t = typename diagram_manager<Dat, Deg, Dom>::diagram_t;
     std::vector<diagram_t> termDs;
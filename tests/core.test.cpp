@@ -12,8 +12,15 @@
 
 #include <fmt/core.h>
 
+#include <algorithm>
 #include <concepts>
 #include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 #include "libteddy/details/operators.hpp"
 #include "libteddy/details/types.hpp"
@@ -202,16 +209,942 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(evaluate, Fixture, Fixtures, Fixture)
     test_compare_eval(evalit, manager, diagram);
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(evaluate_many, Fixture, Fixtures, Fixture)
+{
+    auto expr    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto manager = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto diagram = tsl::make_diagram(expr, manager);
+    BOOST_TEST_MESSAGE(
+        fmt::format("Node count {}", manager.get_node_count(diagram))
+    );
+    auto domainit    = make_domain_iterator(manager);
+    auto evalit      = teddy::tsl::evaluating_iterator(domainit, expr);
+    auto evalend     = tsl::evaluating_iterator_sentinel();
+    auto assignments = std::vector<std::vector<int32>>();
+    auto expected    = std::vector<int32>();
+    auto const Step  = 7;
+    auto i           = 0;
+    while (evalit != evalend)
+    {
+        if (i % Step == 0)
+        {
+            assignments.push_back(evalit.get_var_vals());
+            expected.push_back(*evalit);
+        }
+        ++evalit;
+        ++i;
+    }
+    auto actual = std::vector<int32>();
+    manager.evaluate_many(diagram, assignments, std::back_inserter(actual));
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(
+        actual.begin(),
+        actual.end(),
+        expected.begin(),
+        expected.end()
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE(simulate_bits, teddy::tests::bdd_fixture)
+{
+    auto expr    = make_expression(expressionSettings_, rng_);
+    auto manager = make_manager(managerSettings_, rng_);
+    auto diagram = tsl::make_diagram(expr, manager);
+    BOOST_TEST_MESSAGE(
+        fmt::format("Node count {}", manager.get_node_count(diagram))
+    );
+    auto const WordCount = 8;
+    auto const varCount  = manager.get_var_count();
+    auto wordDist        = std::uniform_int_distribution<uint64>();
+    auto columns         = std::vector<std::vector<uint64>>(as_usize(varCount));
+    for (auto& column : columns)
+    {
+        for (auto w = 0; w < WordCount; ++w)
+        {
+            column.push_back(wordDist(rng_));
+        }
+    }
+
+    auto const words = manager.simulate_bits(diagram, columns);
+    BOOST_REQUIRE_EQUAL(ssize(words), WordCount);
+
+    auto values = std::vector<int32>(as_usize(varCount));
+    for (auto w = 0; w < WordCount; ++w)
+    {
+        for (auto bit = 0; bit < 64; ++bit)
+        {
+            for (auto i = 0; i < varCount; ++i)
+            {
+                auto const column    = columns[as_uindex(i)][as_uindex(w)];
+                values[as_uindex(i)] = static_cast<int32>((column >> bit) & 1);
+            }
+            auto const expected = manager.evaluate(diagram, values);
+            auto const actual
+                = static_cast<int32>((words[as_uindex(w)] >> bit) & 1);
+            BOOST_REQUIRE_EQUAL(expected, actual);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(compile, Fixture, Fixtures, Fixture)
+{
+    auto expr    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto manager = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto diagram = tsl::make_diagram(expr, manager);
+    BOOST_TEST_MESSAGE(
+        fmt::format("Node count {}", manager.get_node_count(diagram))
+    );
+    auto const compiled = manager.compile(diagram);
+    BOOST_REQUIRE_LT(
+        compiled.get_node_count(),
+        manager.get_node_count(diagram)
+    );
+
+    auto domainit = make_domain_iterator(manager);
+    auto evalit   = teddy::tsl::evaluating_iterator(domainit, expr);
+    auto evalend  = tsl::evaluating_iterator_sentinel();
+    while (evalit != evalend)
+    {
+        BOOST_REQUIRE_EQUAL(compiled.evaluate(evalit.get_var_vals()), *evalit);
+        ++evalit;
+    }
+
+    for (auto j = 0; j < Fixture::maxValue_; ++j)
+    {
+        BOOST_REQUIRE_EQUAL(
+            compiled.satisfy_count(j),
+            manager.satisfy_count(j, diagram)
+        );
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(compiled_map_file, Fixture, Fixtures, Fixture)
+{
+    auto expr    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto manager = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto diagram = tsl::make_diagram(expr, manager);
+    BOOST_TEST_MESSAGE(
+        fmt::format("Node count {}", manager.get_node_count(diagram))
+    );
+    auto const compiled = manager.compile(diagram);
+    auto const path
+        = (std::filesystem::temp_directory_path() / "libteddy-test.tddc")
+              .string();
+    BOOST_REQUIRE(compiled.save(path));
+    auto const mapped = compiled_diagram::map_file(path);
+    BOOST_REQUIRE(mapped.has_value());
+    BOOST_REQUIRE_EQUAL(mapped->get_node_count(), compiled.get_node_count());
+    for (auto i = 0; i < manager.get_var_count(); ++i)
+    {
+        BOOST_REQUIRE_EQUAL(
+            mapped->get_node_count(i),
+            compiled.get_node_count(i)
+        );
+    }
+    BOOST_REQUIRE(std::ranges::equal(
+        mapped->get_terminal_values(),
+        compiled.get_terminal_values()
+    ));
+
+    auto domainit = make_domain_iterator(manager);
+    auto evalit   = teddy::tsl::evaluating_iterator(domainit, expr);
+    auto evalend  = tsl::evaluating_iterator_sentinel();
+    while (evalit != evalend)
+    {
+        BOOST_REQUIRE_EQUAL(mapped->evaluate(evalit.get_var_vals()), *evalit);
+        ++evalit;
+    }
+
+    for (auto j = 0; j < Fixture::maxValue_; ++j)
+    {
+        BOOST_REQUIRE_EQUAL(
+            mapped->satisfy_count(j),
+            manager.satisfy_count(j, diagram)
+        );
+    }
+
+    // Malformed files are rejected.
+    auto words = std::vector<int32>(std::filesystem::file_size(path) / 4);
+    std::ifstream(path, std::ios::binary)
+        .read(
+            reinterpret_cast<char*>(words.data()),
+            static_cast<std::streamsize>(words.size() * 4)
+        );
+    auto const is_rejected = [&] (int64 const word, int32 const value)
+    {
+        auto corrupted             = words;
+        corrupted[as_uindex(word)] = value;
+        std::ofstream(path, std::ios::binary)
+            .write(
+                reinterpret_cast<char const*>(corrupted.data()),
+                static_cast<std::streamsize>(corrupted.size() * 4)
+            );
+        return not compiled_diagram::map_file(path).has_value();
+    };
+    auto const headerSize = 7;
+    auto const varCount   = manager.get_var_count();
+    BOOST_REQUIRE(is_rejected(3, 1));
+    BOOST_REQUIRE(is_rejected(headerSize, words[headerSize + 1]));
+    BOOST_REQUIRE(is_rejected(headerSize, varCount));
+    BOOST_REQUIRE(is_rejected(headerSize + varCount, 0));
+    BOOST_REQUIRE(
+        is_rejected(ssize(words) - 1, static_cast<int32>(ssize(words)))
+    );
+    BOOST_REQUIRE(is_rejected(ssize(words) - 1, -1'000));
+    std::filesystem::remove(path);
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(to_cpp_source, Fixture, Fixtures, Fixture)
+{
+    auto expr    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto manager = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto diagram = tsl::make_diagram(expr, manager);
+    BOOST_TEST_MESSAGE(
+        fmt::format("Node count {}", manager.get_node_count(diagram))
+    );
+    auto ost = std::ostringstream();
+    manager.to_cpp_source(ost, diagram, "structure_function", true);
+    auto const source = ost.str();
+    auto const npos   = std::string::npos;
+    BOOST_REQUIRE(source.find("int structure_function(int const* x)") != npos);
+    BOOST_REQUIRE(source.find("structure_function_availability(") != npos);
+
+    auto switchCount = int64 {0};
+    auto pos         = source.find("switch");
+    while (pos != npos)
+    {
+        ++switchCount;
+        pos = source.find("switch", pos + 1);
+    }
+    BOOST_REQUIRE_EQUAL(switchCount, manager.compile(diagram).get_node_count());
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(transfer, Fixture, Fixtures, Fixture)
+{
+    auto expr     = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto rngCopy  = Fixture::rng_;
+    auto manager1 = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto manager2 = make_manager(Fixture::managerSettings_, rngCopy);
+    auto diagram1 = tsl::make_diagram(expr, manager1);
+    auto diagram2 = tsl::make_diagram(expr, manager2);
+    BOOST_TEST_MESSAGE(
+        fmt::format("Node count {}", manager1.get_node_count(diagram1))
+    );
+    auto transferred = manager2.transfer(manager1, diagram1);
+    BOOST_REQUIRE(transferred.equals(diagram2));
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(save_load, Fixture, Fixtures, Fixture)
+{
+    auto expr1    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto expr2    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto rngCopy  = Fixture::rng_;
+    auto rngCopy2 = Fixture::rng_;
+    auto manager1 = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto manager2 = make_manager(Fixture::managerSettings_, rngCopy);
+    auto diagram1 = tsl::make_diagram(expr1, manager1);
+    auto diagram2 = tsl::make_diagram(expr2, manager1);
+    auto constant = manager1.constant(1);
+    auto const path
+        = (std::filesystem::temp_directory_path() / "libteddy-test.tdd")
+              .string();
+    BOOST_REQUIRE(manager1.save({diagram1, diagram2, constant}, path));
+
+    auto loaded1 = manager1.load(path);
+    BOOST_REQUIRE(loaded1.has_value());
+    BOOST_REQUIRE_EQUAL(loaded1->size(), 3);
+    BOOST_REQUIRE((*loaded1)[0].equals(diagram1));
+    BOOST_REQUIRE((*loaded1)[1].equals(diagram2));
+    BOOST_REQUIRE((*loaded1)[2].equals(constant));
+
+    auto loaded2 = manager2.load(path);
+    BOOST_REQUIRE(loaded2.has_value());
+    BOOST_REQUIRE_EQUAL(loaded2->size(), 3);
+    BOOST_REQUIRE(
+        manager2.to_vector((*loaded2)[0]) == manager1.to_vector(diagram1)
+    );
+    BOOST_REQUIRE(
+        manager2.to_vector((*loaded2)[1]) == manager1.to_vector(diagram2)
+    );
+    BOOST_REQUIRE_EQUAL(
+        manager2.get_node_count((*loaded2)[1]),
+        manager1.get_node_count(diagram2)
+    );
+
+    // Small pool makes the loading defer GC and reordering.
+    auto settings       = Fixture::managerSettings_;
+    settings.nodecount_ = 16;
+    auto manager3       = make_manager(settings, rngCopy2);
+    manager3.set_auto_reorder(true);
+    auto loaded3 = manager3.load(path);
+    std::filesystem::remove(path);
+    BOOST_REQUIRE(loaded3.has_value());
+    BOOST_REQUIRE_EQUAL(loaded3->size(), 3);
+    manager3.force_gc();
+    auto const domains = manager1.get_domains();
+    auto values        = std::vector<int32>(domains.size());
+    for (auto j = 0; j < 1'000; ++j)
+    {
+        for (auto i = 0; i < ssize(values); ++i)
+        {
+            values[as_uindex(i)] = std::uniform_int_distribution<int32>(
+                0,
+                domains[as_uindex(i)] - 1
+            )(Fixture::rng_);
+        }
+        BOOST_REQUIRE_EQUAL(
+            manager3.evaluate((*loaded3)[0], values),
+            manager1.evaluate(diagram1, values)
+        );
+        BOOST_REQUIRE_EQUAL(
+            manager3.evaluate((*loaded3)[1], values),
+            manager1.evaluate(diagram2, values)
+        );
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(load_corrupted, teddy::tests::bdd_fixture)
+{
+    auto manager = teddy::bdd_manager(2, 1'000);
+    auto const path
+        = (std::filesystem::temp_directory_path() / "libteddy-test.tdd")
+              .string();
+
+    // Writes x0 AND x1 with 8-byte ids. Level 1 holds the node
+    // for x1 (and its copy if duplicate is set), level 0 the root.
+    auto const load = [&] (
+                          int32 const terminal,
+                          uint64 const sonId,
+                          uint64 const rootId,
+                          bool const duplicate
+                      )
+    {
+        {
+            auto ofst   = std::ofstream(path, std::ios::binary);
+            auto writer = teddy::binary::byte_writer(ofst);
+            for (char const c : teddy::binary::Magic)
+            {
+                writer.write(c);
+            }
+            writer.write(teddy::binary::Version);
+            writer.write(int32 {2});
+            writer.write(int32 {0});
+            writer.write(int32 {1});
+            writer.write(int32 {2});
+            writer.write(int32 {2});
+            writer.write(int64 {2});
+            writer.write(int32 {0});
+            writer.write(terminal);
+            writer.write(int64 {1});
+            writer.write(int64 {duplicate ? 2 : 1});
+            writer.write(int32 {8});
+            writer.write(uint64 {0});
+            writer.write(sonId);
+            if (duplicate)
+            {
+                writer.write(uint64 {0});
+                writer.write(uint64 {1});
+            }
+            writer.write(uint64 {0});
+            writer.write(uint64 {duplicate ? 3U : 2U});
+            writer.write(int64 {1});
+            writer.write(rootId);
+        }
+        auto loaded = manager.load(path);
+        std::filesystem::remove(path);
+        return loaded;
+    };
+
+    auto const x01 = manager.apply<ops::AND>(
+        manager.variable(0),
+        manager.variable(1)
+    );
+    auto const valid = load(1, 1, 3, false);
+    BOOST_REQUIRE(valid.has_value());
+    BOOST_REQUIRE((*valid)[0].equals(x01));
+
+    // Duplicate records are merged instead of inserted twice.
+    auto const nodeCount = manager.get_node_count();
+    auto const duplicate = load(1, 1, 4, true);
+    BOOST_REQUIRE(duplicate.has_value());
+    BOOST_REQUIRE((*duplicate)[0].equals(x01));
+    BOOST_REQUIRE_EQUAL(manager.get_node_count(), nodeCount);
+
+    BOOST_REQUIRE(not load(-1, 1, 3, false).has_value());
+    BOOST_REQUIRE(not load(Undefined, 1, 3, false).has_value());
+    BOOST_REQUIRE(not load(1, ~uint64 {0}, 3, false).has_value());
+    BOOST_REQUIRE(not load(1, 2, 3, false).has_value());
+    BOOST_REQUIRE(not load(1, 1, ~uint64 {0}, false).has_value());
+    BOOST_REQUIRE(not load(1, 1, 4, false).has_value());
+
+    // Rejected loads do not leave any node marked.
+    BOOST_REQUIRE_EQUAL(manager.get_node_count(x01), 4);
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(fold, Fixture, Fixtures, Fixture)
 {
     auto expr    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
     auto manager = make_manager(Fixture::managerSettings_, Fixture::rng_);
     auto diagram1 = tsl::make_diagram(expr, manager, fold_type::Left);
     auto diagram2 = tsl::make_diagram(expr, manager, fold_type::Tree);
+    auto diagram3 = tsl::make_diagram(expr, manager, fold_type::SizeOrdered);
     BOOST_TEST_MESSAGE(
         fmt::format("Node count {}", manager.get_node_count(diagram1))
     );
     BOOST_REQUIRE(diagram1.equals(diagram2));
+    BOOST_REQUIRE(diagram1.equals(diagram3));
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(to_dot_graph, Fixture, Fixtures, Fixture)
+{
+    auto expr    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto manager = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto diagram = tsl::make_diagram(expr, manager);
+    BOOST_TEST_MESSAGE(
+        fmt::format("Node count {}", manager.get_node_count(diagram))
+    );
+    auto const count = [] (std::string const& str, std::string const& sub)
+    {
+        auto result = int64 {0};
+        auto pos    = str.find(sub);
+        while (pos != std::string::npos)
+        {
+            ++result;
+            pos = str.find(sub, pos + 1);
+        }
+        return result;
+    };
+
+    auto ost = std::ostringstream();
+    manager.to_dot_graph(ost, diagram);
+    auto const full = ost.str();
+    BOOST_REQUIRE_EQUAL(
+        count(full, "tooltip"),
+        manager.get_node_count(diagram)
+    );
+    BOOST_REQUIRE_EQUAL(count(full, "cut"), 0);
+
+    auto constexpr MaxNodeCount = 5;
+    auto windowOst              = std::ostringstream();
+    manager.to_dot_graph(windowOst, diagram, 1, 4, MaxNodeCount);
+    auto const window = windowOst.str();
+    BOOST_REQUIRE_LE(count(window, "tooltip"), MaxNodeCount);
+    BOOST_REQUIRE_EQUAL(count(window, "shape = square"), 0);
+
+    auto emptyOst = std::ostringstream();
+    manager.to_dot_graph(emptyOst, diagram, 0, manager.get_var_count(), -1);
+    BOOST_REQUIRE_EQUAL(count(emptyOst.str(), "tooltip"), 0);
+
+    auto rootOst = std::ostringstream();
+    manager.to_dot_graph(rootOst, diagram, 0, manager.get_var_count() + 1, 1);
+    auto const root = rootOst.str();
+    BOOST_REQUIRE_EQUAL(count(root, "tooltip"), 1);
+    BOOST_REQUIRE_EQUAL(count(root, "-> cut"), count(root, "->"));
+
+    // Leftover marks would break the traversal in get_node_count.
+    BOOST_REQUIRE_EQUAL(
+        manager.get_node_count(diagram),
+        count(full, "tooltip")
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(
+    register_operation,
+    Fixture,
+    Fixtures,
+    Fixture
+)
+{
+    auto constexpr AssignmentCount = 1'000;
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto expr1    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto expr2    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto diagram1 = tsl::make_diagram(expr1, manager);
+    auto diagram2 = tsl::make_diagram(expr2, manager);
+    auto absDiff  = manager.register_operation(
+        [] (int32 const l, int32 const r) { return l < r ? r - l : l - r; },
+        true
+    );
+    auto monus = manager.register_operation(
+        [] (int32 const l, int32 const r) { return l < r ? 0 : l - r; }
+    );
+    BOOST_REQUIRE_NE(absDiff.get_id(), monus.get_id());
+
+    auto const diff12  = manager.apply(absDiff, diagram1, diagram2);
+    auto const diff21  = manager.apply(absDiff, diagram2, diagram1);
+    auto const monus12 = manager.apply(monus, diagram1, diagram2);
+    auto const monus21 = manager.apply(monus, diagram2, diagram1);
+    BOOST_REQUIRE(diff12.equals(diff21));
+
+    auto const domains = manager.get_domains();
+    auto values        = std::vector<int32>(domains.size());
+    for (auto i = 0; i < AssignmentCount; ++i)
+    {
+        for (auto index = 0; index < ssize(values); ++index)
+        {
+            auto dist = std::uniform_int_distribution<int32>(
+                0,
+                domains[as_uindex(index)] - 1
+            );
+            values[as_uindex(index)] = dist(Fixture::rng_);
+        }
+        auto const value1 = manager.evaluate(diagram1, values);
+        auto const value2 = manager.evaluate(diagram2, values);
+        BOOST_REQUIRE_EQUAL(
+            manager.evaluate(diff12, values),
+            value1 < value2 ? value2 - value1 : value1 - value2
+        );
+        BOOST_REQUIRE_EQUAL(
+            manager.evaluate(monus12, values),
+            value1 < value2 ? 0 : value1 - value2
+        );
+        BOOST_REQUIRE_EQUAL(
+            manager.evaluate(monus21, values),
+            value2 < value1 ? 0 : value2 - value1
+        );
+    }
+
+    // Two ids are already taken, the rest of the range is used up here.
+    auto constexpr PersistentIdCount = 1'047'552;
+    auto const first = [] (int32 const l, int32) { return l; };
+    for (auto i = 2; i < PersistentIdCount; ++i)
+    {
+        static_cast<void>(manager.register_operation(first));
+    }
+    BOOST_REQUIRE_THROW(manager.register_operation(first), std::runtime_error);
+}
+
+BOOST_FIXTURE_TEST_CASE(ite, teddy::tests::bdd_fixture)
+{
+    auto manager = make_manager(managerSettings_, rng_);
+    auto exprF   = make_expression(expressionSettings_, rng_);
+    auto exprG   = make_expression(expressionSettings_, rng_);
+    auto exprH   = make_expression(expressionSettings_, rng_);
+    auto f       = tsl::make_diagram(exprF, manager);
+    auto g       = tsl::make_diagram(exprG, manager);
+    auto h       = tsl::make_diagram(exprH, manager);
+    auto fg      = manager.apply<ops::AND>(f, g);
+    auto nfh     = manager.apply<ops::AND>(manager.negate(f), h);
+    auto one     = manager.constant(1);
+    auto zero    = manager.constant(0);
+    BOOST_REQUIRE(manager.ite(f, g, h).equals(manager.apply<ops::OR>(fg, nfh)));
+    BOOST_REQUIRE(manager.ite(f, one, h).equals(manager.apply<ops::OR>(f, h)));
+    BOOST_REQUIRE(manager.ite(h, one, f).equals(manager.apply<ops::OR>(f, h)));
+    BOOST_REQUIRE(manager.ite(f, g, zero).equals(fg));
+    BOOST_REQUIRE(manager.ite(g, f, zero).equals(fg));
+    BOOST_REQUIRE(manager.ite(f, f, h).equals(manager.apply<ops::OR>(f, h)));
+    BOOST_REQUIRE(manager.ite(f, g, f).equals(fg));
+    BOOST_REQUIRE(manager.ite(f, one, zero).equals(f));
+    BOOST_REQUIRE(manager.ite(f, zero, one).equals(manager.negate(f)));
+}
+
+BOOST_FIXTURE_TEST_CASE(quantification, teddy::tests::bdd_fixture)
+{
+    auto manager  = make_manager(managerSettings_, rng_);
+    auto exprF    = make_expression(expressionSettings_, rng_);
+    auto exprG    = make_expression(expressionSettings_, rng_);
+    auto f        = tsl::make_diagram(exprF, manager);
+    auto g        = tsl::make_diagram(exprG, manager);
+    auto varDist  = std::uniform_int_distribution<int32>(
+        0,
+        manager.get_var_count() - 1
+    );
+    auto vars = std::vector<int32>();
+    for (auto i = 0; i < manager.get_var_count() / 3; ++i)
+    {
+        vars.push_back(varDist(rng_));
+    }
+
+    // Quantifies one variable at a time using cofactors.
+    auto expectedExists = f;
+    auto expectedForall = f;
+    auto expectedAndEx  = manager.apply<ops::AND>(f, g);
+    for (auto const index : vars)
+    {
+        expectedExists = manager.apply<ops::OR>(
+            manager.get_cofactor(expectedExists, index, 0),
+            manager.get_cofactor(expectedExists, index, 1)
+        );
+        expectedForall = manager.apply<ops::AND>(
+            manager.get_cofactor(expectedForall, index, 0),
+            manager.get_cofactor(expectedForall, index, 1)
+        );
+        expectedAndEx = manager.apply<ops::OR>(
+            manager.get_cofactor(expectedAndEx, index, 0),
+            manager.get_cofactor(expectedAndEx, index, 1)
+        );
+    }
+
+    auto const actualExists = manager.exists(f, vars);
+    auto const actualForall = manager.forall(f, vars);
+    auto const actualAndEx  = manager.and_exists(f, g, vars);
+    BOOST_REQUIRE(actualExists.equals(expectedExists));
+    BOOST_REQUIRE(actualForall.equals(expectedForall));
+    BOOST_REQUIRE(actualAndEx.equals(expectedAndEx));
+    BOOST_REQUIRE_EQUAL(
+        manager.get_node_count(actualAndEx),
+        manager.get_node_count(expectedAndEx)
+    );
+    BOOST_REQUIRE(manager.exists(f, {}).equals(f));
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(abstract, Fixture, Fixtures, Fixture)
+{
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto expr     = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto diagram  = tsl::make_diagram(expr, manager);
+    auto domains  = manager.get_domains();
+    auto varDist  = std::uniform_int_distribution<int32>(
+        0,
+        manager.get_var_count() - 1
+    );
+    auto vars = std::vector<int32>();
+    for (auto i = 0; i < manager.get_var_count() / 3; ++i)
+    {
+        vars.push_back(varDist(Fixture::rng_));
+    }
+
+    // Merges cofactors of one variable at a time.
+    auto expectedMax = diagram;
+    auto expectedMin = diagram;
+    for (auto const index : vars)
+    {
+        auto maxCofactors = std::vector<decltype(diagram)>();
+        auto minCofactors = std::vector<decltype(diagram)>();
+        for (auto k = 0; k < domains[as_uindex(index)]; ++k)
+        {
+            maxCofactors.push_back(manager.get_cofactor(expectedMax, index, k));
+            minCofactors.push_back(manager.get_cofactor(expectedMin, index, k));
+        }
+        expectedMax = manager.template left_fold<ops::MAX>(maxCofactors);
+        expectedMin = manager.template left_fold<ops::MIN>(minCofactors);
+    }
+
+    auto const actualMax = manager.template abstract<ops::MAX>(diagram, vars);
+    auto const actualMin = manager.template abstract<ops::MIN>(diagram, vars);
+    BOOST_REQUIRE(actualMax.equals(expectedMax));
+    BOOST_REQUIRE(actualMin.equals(expectedMin));
+    BOOST_REQUIRE_EQUAL(
+        manager.get_node_count(actualMax),
+        manager.get_node_count(expectedMax)
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(case_of, Fixture, Fixtures, Fixture)
+{
+    auto constexpr AssignmentCount = 1'000;
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto expr     = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto selector = tsl::make_diagram(expr, manager);
+    auto branches = std::vector<decltype(manager.constant(0))>();
+    for (auto j = 0; j < Fixture::maxValue_; ++j)
+    {
+        auto branchExpr
+            = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+        branches.push_back(tsl::make_diagram(branchExpr, manager));
+    }
+    auto const result = manager.case_of(selector, branches);
+
+    auto const domains = manager.get_domains();
+    auto values        = std::vector<int32>(domains.size());
+    for (auto i = 0; i < AssignmentCount; ++i)
+    {
+        for (auto index = 0; index < ssize(values); ++index)
+        {
+            auto dist = std::uniform_int_distribution<int32>(
+                0,
+                domains[as_uindex(index)] - 1
+            );
+            values[as_uindex(index)] = dist(Fixture::rng_);
+        }
+        auto const branch = manager.evaluate(selector, values);
+        BOOST_REQUIRE_EQUAL(
+            manager.evaluate(result, values),
+            manager.evaluate(branches[as_uindex(branch)], values)
+        );
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(compose, Fixture, Fixtures, Fixture)
+{
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto expr     = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto diagram  = tsl::make_diagram(expr, manager);
+    auto varDist  = std::uniform_int_distribution<int32>(
+        0,
+        manager.get_var_count() - 1
+    );
+    for (auto i = 0; i < 5; ++i)
+    {
+        auto const index  = varDist(Fixture::rng_);
+        auto const domain = manager.get_domains()[as_uindex(index)];
+        auto replExpr
+            = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+        auto const replacement = manager.transform(
+            tsl::make_diagram(replExpr, manager),
+            [domain] (int32 const value) { return value % domain; }
+        );
+        auto branches = std::vector<decltype(manager.constant(0))>();
+        for (auto k = 0; k < domain; ++k)
+        {
+            branches.push_back(manager.get_cofactor(diagram, index, k));
+        }
+        auto const expected = manager.case_of(replacement, branches);
+        auto const actual   = manager.compose(diagram, index, replacement);
+        BOOST_REQUIRE(actual.equals(expected));
+        BOOST_REQUIRE_EQUAL(
+            manager.get_node_count(actual),
+            manager.get_node_count(expected)
+        );
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(vector_compose, Fixture, Fixtures, Fixture)
+{
+    auto constexpr AssignmentCount = 1'000;
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto expr     = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto diagram  = tsl::make_diagram(expr, manager);
+    auto const domains = manager.get_domains();
+
+    auto varDist  = std::uniform_int_distribution<int32>(
+        0,
+        manager.get_var_count() - 1
+    );
+
+    // Every other variable is replaced by itself.
+    auto replacements = std::vector<decltype(manager.constant(0))>();
+    for (auto index = 0; index < manager.get_var_count(); ++index)
+    {
+        if (index % 2 == 0)
+        {
+            replacements.push_back(manager.variable(index));
+            continue;
+        }
+        auto const domain = domains[as_uindex(index)];
+        auto const max    = manager.template apply<ops::MAX>(
+            manager.variable(varDist(Fixture::rng_)),
+            manager.variable(varDist(Fixture::rng_))
+        );
+        replacements.push_back(manager.transform(
+            max,
+            [domain] (int32 const value) { return value % domain; }
+        ));
+    }
+    auto const result = manager.vector_compose(diagram, replacements);
+
+    auto values   = std::vector<int32>(domains.size());
+    auto composed = std::vector<int32>(domains.size());
+    for (auto i = 0; i < AssignmentCount; ++i)
+    {
+        for (auto index = 0; index < ssize(values); ++index)
+        {
+            auto dist = std::uniform_int_distribution<int32>(
+                0,
+                domains[as_uindex(index)] - 1
+            );
+            values[as_uindex(index)] = dist(Fixture::rng_);
+        }
+        for (auto index = 0; index < ssize(values); ++index)
+        {
+            composed[as_uindex(index)]
+                = manager.evaluate(replacements[as_uindex(index)], values);
+        }
+        BOOST_REQUIRE_EQUAL(
+            manager.evaluate(result, values),
+            manager.evaluate(diagram, composed)
+        );
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(rename, Fixture, Fixtures, Fixture)
+{
+    auto constexpr AssignmentCount = 1'000;
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto expr     = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto diagram  = tsl::make_diagram(expr, manager);
+    auto const domains = manager.get_domains();
+    auto const& order  = manager.get_order();
+
+    // Order-preserving renaming moves variables at even levels one level
+    // down if the domains match.
+    auto variables = std::vector<decltype(manager.constant(0))>();
+    auto moved     = std::vector<decltype(manager.constant(0))>();
+    auto shift     = std::vector<int32>(domains.size());
+    for (auto index = 0; index < ssize(shift); ++index)
+    {
+        shift[as_uindex(index)] = index;
+    }
+    for (auto level = 0; level + 1 < ssize(order); level += 2)
+    {
+        auto const index   = order[as_uindex(level)];
+        auto const nextIdx = order[as_uindex(level + 1)];
+        auto const isMoved
+            = domains[as_uindex(index)] == domains[as_uindex(nextIdx)];
+        shift[as_uindex(index)] = isMoved ? nextIdx : index;
+        variables.push_back(manager.variable(index));
+        moved.push_back(manager.variable(shift[as_uindex(index)]));
+    }
+    auto const maxOfVars = manager.template left_fold<ops::MAX>(variables);
+    auto const expected  = manager.template left_fold<ops::MAX>(moved);
+    auto const shifted   = manager.rename(maxOfVars, shift);
+    BOOST_REQUIRE(shifted.equals(expected));
+    BOOST_REQUIRE_EQUAL(
+        manager.get_node_count(shifted),
+        manager.get_node_count(expected)
+    );
+
+    // General renaming permutes variables with the same domain.
+    auto mapping = std::vector<int32>(domains.size());
+    for (auto index = 0; index < ssize(mapping); ++index)
+    {
+        mapping[as_uindex(index)] = index;
+    }
+    for (auto i = ssize(mapping) - 1; i > 0; --i)
+    {
+        auto dist    = std::uniform_int_distribution<int64>(0, i);
+        auto const j = dist(Fixture::rng_);
+        if (domains[as_uindex(mapping[as_uindex(i)])]
+            == domains[as_uindex(mapping[as_uindex(j)])])
+        {
+            std::swap(mapping[as_uindex(i)], mapping[as_uindex(j)]);
+        }
+    }
+    auto const renamed = manager.rename(diagram, mapping);
+
+    auto values        = std::vector<int32>(domains.size());
+    auto renamedValues = std::vector<int32>(domains.size());
+    for (auto i = 0; i < AssignmentCount; ++i)
+    {
+        for (auto index = 0; index < ssize(values); ++index)
+        {
+            auto dist = std::uniform_int_distribution<int32>(
+                0,
+                domains[as_uindex(index)] - 1
+            );
+            values[as_uindex(index)] = dist(Fixture::rng_);
+        }
+        for (auto index = 0; index < ssize(values); ++index)
+        {
+            renamedValues[as_uindex(index)]
+                = values[as_uindex(mapping[as_uindex(index)])];
+        }
+        BOOST_REQUIRE_EQUAL(
+            manager.evaluate(renamed, values),
+            manager.evaluate(diagram, renamedValues)
+        );
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(constrain, Fixture, Fixtures, Fixture)
+{
+    auto constexpr AssignmentCount = 1'000;
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto expr     = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto diagram  = tsl::make_diagram(expr, manager);
+    auto careExpr = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto careSet  = manager.transform(
+        tsl::make_diagram(careExpr, manager),
+        [] (int32 const value) { return value == 0 ? 0 : 1; }
+    );
+    auto const constrained = manager.constrain(diagram, careSet);
+    auto const restricted  = manager.restrict(diagram, careSet);
+
+    BOOST_REQUIRE_LE(
+        manager.get_node_count(restricted),
+        manager.get_node_count(diagram)
+    );
+
+    auto const dependencies = manager.get_dependency_set(diagram);
+    for (auto const index : manager.get_dependency_set(restricted))
+    {
+        BOOST_REQUIRE(
+            std::find(dependencies.begin(), dependencies.end(), index)
+            != dependencies.end()
+        );
+    }
+
+    auto const domains = manager.get_domains();
+    auto values        = std::vector<int32>(domains.size());
+    for (auto i = 0; i < AssignmentCount; ++i)
+    {
+        for (auto index = 0; index < ssize(values); ++index)
+        {
+            auto dist = std::uniform_int_distribution<int32>(
+                0,
+                domains[as_uindex(index)] - 1
+            );
+            values[as_uindex(index)] = dist(Fixture::rng_);
+        }
+        if (manager.evaluate(careSet, values) == 1)
+        {
+            auto const expected = manager.evaluate(diagram, values);
+            BOOST_REQUIRE_EQUAL(
+                manager.evaluate(constrained, values),
+                expected
+            );
+            BOOST_REQUIRE_EQUAL(
+                manager.evaluate(restricted, values),
+                expected
+            );
+        }
+    }
+
+    auto const one = manager.constant(1);
+    BOOST_REQUIRE(manager.constrain(diagram, one).equals(diagram));
+    BOOST_REQUIRE(manager.restrict(diagram, one).equals(diagram));
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(tree_fold_parallel, Fixture, Fixtures, Fixture)
+{
+    auto constexpr DiagramCount = 7;
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto diagrams = std::vector<decltype(manager.constant(0))>();
+    for (auto i = 0; i < DiagramCount; ++i)
+    {
+        auto expr
+            = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+        diagrams.push_back(tsl::make_diagram(expr, manager));
+    }
+    auto copy     = diagrams;
+    auto expected = manager.template tree_fold<ops::MAX>(copy);
+    for (auto const threadCount : {1, 2, 3, 4})
+    {
+        auto const actual = manager.template tree_fold_parallel<ops::MAX>(
+            diagrams,
+            threadCount
+        );
+        BOOST_REQUIRE(actual.equals(expected));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(apply_n, Fixture, Fixtures, Fixture)
+{
+    auto constexpr DiagramCount = 7;
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto diagrams = std::vector<decltype(manager.constant(0))>();
+    for (auto i = 0; i < DiagramCount; ++i)
+    {
+        auto expr
+            = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+        diagrams.push_back(tsl::make_diagram(expr, manager));
+    }
+    auto copy         = diagrams;
+    auto const expMin = manager.template left_fold<ops::MIN>(copy);
+    auto const expMax = manager.template left_fold<ops::MAX>(copy);
+    auto const actMin = manager.template apply_n<ops::MIN>(diagrams);
+    auto const actMax = manager.template apply_n<ops::MAX>(diagrams);
+    BOOST_REQUIRE(actMin.equals(expMin));
+    BOOST_REQUIRE(actMax.equals(expMax));
+    auto const expMax3 = manager.template apply<ops::MAX>(
+        manager.template apply<ops::MAX>(diagrams[0], diagrams[1]),
+        diagrams[2]
+    );
+    auto const actMax3 = manager.template apply_n<ops::MAX>(
+        diagrams[0],
+        diagrams[1],
+        diagrams[2]
+    );
+    BOOST_REQUIRE(actMax3.equals(expMax3));
 }
 
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(gc, Fixture, Fixtures, Fixture)
@@ -814,6 +1747,56 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(to_vector, Fixture, Fixtures, Fixture)
         diagram.equals(vectord),
         "From-vector from to-vectored vector created the same diagram"
     );
+    auto inserted = std::vector<int32>();
+    manager.to_vector_g(diagram, std::back_inserter(inserted));
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(
+        inserted.begin(),
+        inserted.end(),
+        vector.begin(),
+        vector.end()
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(
+    from_vector_parallel,
+    Fixture,
+    Fixtures,
+    Fixture
+)
+{
+    auto expr    = make_expression(Fixture::expressionSettings_, Fixture::rng_);
+    auto manager = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto diagram = tsl::make_diagram(expr, manager);
+    BOOST_TEST_MESSAGE(
+        fmt::format("Node count {}", manager.get_node_count(diagram))
+    );
+    auto const vector = manager.to_vector(diagram);
+    for (auto const threadCount : {1, 2, 4})
+    {
+        auto vectord = manager.from_vector_parallel(vector, threadCount);
+        BOOST_REQUIRE_MESSAGE(
+            diagram.equals(vectord),
+            "Parallel from-vector created the same diagram"
+        );
+    }
+
+    auto const path = std::filesystem::temp_directory_path()
+                    / "libteddy-test-from-vector-parallel.bin";
+    {
+        auto ofst = std::ofstream(path, std::ios::binary);
+        ofst.write(
+            reinterpret_cast<char const*>(vector.data()),
+            static_cast<std::streamsize>(vector.size() * sizeof(int32))
+        );
+    }
+    auto const file = teddy::mapped_file::load_file(path.string());
+    BOOST_REQUIRE(file.has_value());
+    auto vectord = manager.from_vector_parallel(file->as_span<int32>(), 4);
+    std::filesystem::remove(path);
+    BOOST_REQUIRE_MESSAGE(
+        diagram.equals(vectord),
+        "Parallel from-vector from mapped file created the same diagram"
+    );
 }
 
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(from_expression, Fixture, Fixtures, Fixture)
@@ -828,6 +1811,481 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(from_expression, Fixture, Fixtures, Fixture)
     auto domainit = tsl::domain_iterator(manager.get_domains());
     auto evalit   = teddy::tsl::evaluating_iterator(domainit, *exprtree);
     test_compare_eval(evalit, manager, diagram);
+
+    // Cached results of the first construction must not be reused.
+    manager.force_gc();
+    auto const other = tsl::make_expression_tree(
+        manager.get_var_count(),
+        Fixture::rng_,
+        Fixture::rng_
+    );
+    auto const otherDiagram  = manager.from_expression_tree(*other);
+    auto const otherDomainit = tsl::domain_iterator(manager.get_domains());
+    auto const otherEvalit
+        = teddy::tsl::evaluating_iterator(otherDomainit, *other);
+    test_compare_eval(otherEvalit, manager, otherDiagram);
+    BOOST_REQUIRE(manager.from_expression_tree(*exprtree).equals(diagram));
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(
+    from_expression_dag,
+    Fixture,
+    Fixtures,
+    Fixture
+)
+{
+    // Minimal expression node whose sons can be shared.
+    struct dag_node
+    {
+        int32 index_;
+        bool isMax_;
+        dag_node const* left_;
+        dag_node const* right_;
+
+        auto is_variable () const -> bool { return left_ == nullptr; }
+        auto is_constant () const -> bool { return false; }
+        auto is_operation () const -> bool { return left_ != nullptr; }
+        auto get_index () const -> int32 { return index_; }
+        auto get_value () const -> int32 { return 0; }
+        auto get_left () const -> dag_node const& { return *left_; }
+        auto get_right () const -> dag_node const& { return *right_; }
+        auto evaluate (int32 const l, int32 const r) const -> int32
+        {
+            return isMax_ ? std::max(l, r) : std::min(l, r);
+        }
+    };
+
+    // Each gate uses the two previous gates. As a tree, the expression
+    // would have exponentially many nodes.
+    auto constexpr GateCount = 100;
+    auto manager  = make_manager(Fixture::managerSettings_, Fixture::rng_);
+    auto varCount = manager.get_var_count();
+    auto nodes    = std::vector<dag_node>();
+    auto gates    = std::vector<dag_node const*>();
+    auto expected = std::vector<decltype(manager.constant(0))>();
+    nodes.reserve(3 * GateCount);
+    auto const make_node = [&nodes] (dag_node const node)
+    {
+        nodes.push_back(node);
+        return &nodes.back();
+    };
+    auto const apply = [&manager] (bool isMax, auto const& l, auto const& r)
+    {
+        return isMax ? manager.template apply<ops::MAX>(l, r)
+                     : manager.template apply<ops::MIN>(l, r);
+    };
+    gates.push_back(make_node(dag_node {0, false, nullptr, nullptr}));
+    gates.push_back(make_node(dag_node {1, false, nullptr, nullptr}));
+    expected.push_back(manager.variable(0));
+    expected.push_back(manager.variable(1));
+    for (auto i = 2; i < GateCount; ++i)
+    {
+        auto const index = i % varCount;
+        auto const isMax = i % 2 == 0;
+        auto const var   = make_node(dag_node {index, false, nullptr, nullptr});
+        auto const inner
+            = make_node(dag_node {0, isMax, gates[as_uindex(i - 1)], var});
+        gates.push_back(make_node(
+            dag_node {0, not isMax, inner, gates[as_uindex(i - 2)]}
+        ));
+        auto const innerDiagram = apply(
+            isMax,
+            expected[as_uindex(i - 1)],
+            manager.variable(index)
+        );
+        expected.push_back(
+            apply(not isMax, innerDiagram, expected[as_uindex(i - 2)])
+        );
+    }
+    auto const actual = manager.from_expression_tree(*gates.back());
+    BOOST_REQUIRE(actual.equals(expected.back()));
+}
+
+BOOST_FIXTURE_TEST_CASE(from_pla, teddy::tests::bdd_fixture)
+{
+    auto constexpr LineCount       = 40;
+    auto constexpr FunctionCount   = 3;
+    auto constexpr AssignmentCount = 10'000;
+    auto manager     = make_manager(managerSettings_, rng_);
+    auto varCount    = manager.get_var_count();
+    auto literalDist = std::uniform_int_distribution<int32>(0, 3);
+    auto valueDist   = std::uniform_int_distribution<int32>(0, 1);
+
+    // Random PLA with don't cares in both parts.
+    auto cubes   = std::vector<std::string>();
+    auto outputs = std::vector<std::string>();
+    for (auto li = 0; li < LineCount; ++li)
+    {
+        auto& cube = cubes.emplace_back();
+        for (auto i = 0; i < varCount; ++i)
+        {
+            auto const literal = literalDist(rng_);
+            cube.push_back(literal == 0 ? '0' : literal == 1 ? '1' : '-');
+        }
+        auto& output = outputs.emplace_back();
+        for (auto fi = 0; fi < FunctionCount; ++fi)
+        {
+            output.push_back(valueDist(rng_) == 1 ? '1' : '-');
+        }
+    }
+
+    auto const path
+        = std::filesystem::temp_directory_path() / "libteddy-test.pla";
+    {
+        auto ofst = std::ofstream(path);
+        ofst << "# test file\n"
+             << ".i " << varCount << "\n"
+             << ".o " << FunctionCount << "\n"
+             << ".ob f g h\n"
+             << ".p " << LineCount << "\n";
+        for (auto li = 0; li < LineCount; ++li)
+        {
+            ofst << cubes[as_uindex(li)] << " " << outputs[as_uindex(li)]
+                 << "\n";
+        }
+        ofst << ".e\n";
+    }
+
+    auto const file = teddy::pla_file::load_file(path.string());
+    auto stream     = teddy::pla_stream::open_file(path.string());
+    std::filesystem::remove(path);
+    BOOST_REQUIRE(file.has_value());
+    BOOST_REQUIRE(stream.has_value());
+    BOOST_REQUIRE_EQUAL(file->get_line_count(), LineCount);
+    BOOST_REQUIRE_EQUAL(file->get_output_labels().size(), FunctionCount);
+    BOOST_REQUIRE_EQUAL(file->get_output_labels()[1], "g");
+
+    auto const diagrams1 = manager.from_pla(*file);
+    auto const diagrams2 = manager.from_pla(*stream);
+    BOOST_REQUIRE(diagrams2.has_value());
+    BOOST_REQUIRE_EQUAL(diagrams1.size(), FunctionCount);
+    BOOST_REQUIRE_EQUAL(diagrams2->size(), FunctionCount);
+
+    auto const diagrams3 = manager.from_pla_parallel(*file, 2);
+    BOOST_REQUIRE_EQUAL(diagrams3.size(), FunctionCount);
+    for (auto fi = 0; fi < FunctionCount; ++fi)
+    {
+        auto const& diagram1 = diagrams1[as_uindex(fi)];
+        BOOST_REQUIRE(diagram1.equals(diagrams3[as_uindex(fi)]));
+    }
+
+    auto values = std::vector<int32>(as_usize(varCount));
+    for (auto j = 0; j < AssignmentCount; ++j)
+    {
+        for (auto& value : values)
+        {
+            value = valueDist(rng_);
+        }
+
+        for (auto fi = 0; fi < FunctionCount; ++fi)
+        {
+            auto expected = 0;
+            for (auto li = 0; li < LineCount && expected == 0; ++li)
+            {
+                auto const& cube = cubes[as_uindex(li)];
+                auto isMatch     = outputs[as_uindex(li)][as_uindex(fi)] == '1';
+                for (auto i = 0; i < varCount && isMatch; ++i)
+                {
+                    auto const c = cube[as_uindex(i)];
+                    isMatch      = c == '-' || c - '0' == values[as_uindex(i)];
+                }
+                expected = isMatch ? 1 : 0;
+            }
+            auto const& diagram1 = diagrams1[as_uindex(fi)];
+            auto const& diagram2 = (*diagrams2)[as_uindex(fi)];
+            BOOST_REQUIRE_EQUAL(manager.evaluate(diagram1, values), expected);
+            BOOST_REQUIRE_EQUAL(manager.evaluate(diagram2, values), expected);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(from_pla_products, teddy::tests::bdd_fixture)
+{
+    using diagram_t = teddy::bdd_manager::diagram_t;
+    auto manager    = teddy::bdd_manager(4, 1'000);
+    auto const path
+        = std::filesystem::temp_directory_path() / "libteddy-test.pla";
+    auto const load = [&] (std::string const& content)
+    {
+        std::ofstream(path) << content;
+        auto file   = teddy::pla_file::load_file(path.string());
+        auto stream = teddy::pla_stream::open_file(path.string());
+        std::filesystem::remove(path);
+        BOOST_REQUIRE(file.has_value());
+        BOOST_REQUIRE(stream.has_value());
+        auto diagrams1 = manager.from_pla(*file);
+        auto diagrams2 = manager.from_pla(*stream);
+        BOOST_REQUIRE(diagrams2.has_value());
+        BOOST_REQUIRE_EQUAL(diagrams1.size(), diagrams2->size());
+        for (auto fi = 0; fi < ssize(diagrams1); ++fi)
+        {
+            BOOST_REQUIRE(
+                diagrams1[as_uindex(fi)].equals((*diagrams2)[as_uindex(fi)])
+            );
+        }
+        return diagrams1;
+    };
+    auto const product = [&manager] (std::string const& cube)
+    {
+        auto literals = std::vector<diagram_t> {manager.constant(1)};
+        for (auto i = 0; i < ssize(cube); ++i)
+        {
+            if (cube[as_uindex(i)] != '-')
+            {
+                literals.push_back(
+                    cube[as_uindex(i)] == '1' ? manager.variable(i)
+                                              : manager.variable_not(i)
+                );
+            }
+        }
+        return manager.left_fold<ops::AND>(literals);
+    };
+
+    // Tautology cube does not leave any node marked.
+    auto const x01 = manager.apply<ops::AND>(
+        manager.variable(0),
+        manager.variable(1)
+    );
+    auto const tautology = load(".i 4\n.o 1\n.p 1\n---- 1\n.e\n");
+    BOOST_REQUIRE(tautology[0].equals(manager.constant(1)));
+    BOOST_REQUIRE_EQUAL(manager.get_node_count(x01), 4);
+    BOOST_REQUIRE_EQUAL(manager.get_node_count(tautology[0]), 1);
+
+    // Functions share groups of lines with the same output part.
+    auto const cubes   = std::vector<std::string> {
+        "1-0-",
+        "01--",
+        "--11",
+        "0--1",
+        "1111"
+    };
+    auto const outputs = std::vector<std::string> {
+        "110",
+        "110",
+        "011",
+        "100",
+        "000"
+    };
+    auto content = std::string(".i 4\n.o 3\n.p 5\n");
+    for (auto li = 0; li < ssize(cubes); ++li)
+    {
+        content += cubes[as_uindex(li)] + " " + outputs[as_uindex(li)] + "\n";
+    }
+    content += ".e\n";
+    auto const actual = load(content);
+    BOOST_REQUIRE_EQUAL(actual.size(), 3);
+    for (auto fi = 0; fi < 3; ++fi)
+    {
+        auto products = std::vector<diagram_t> {manager.constant(0)};
+        for (auto li = 0; li < ssize(cubes); ++li)
+        {
+            if (outputs[as_uindex(li)][as_uindex(fi)] == '1')
+            {
+                products.push_back(product(cubes[as_uindex(li)]));
+            }
+        }
+        auto const expected = manager.left_fold<ops::OR>(products);
+        BOOST_REQUIRE(actual[as_uindex(fi)].equals(expected));
+        BOOST_REQUIRE_EQUAL(
+            manager.get_node_count(actual[as_uindex(fi)]),
+            manager.get_node_count(expected)
+        );
+    }
+    BOOST_REQUIRE_EQUAL(manager.get_node_count(x01), 4);
+}
+
+BOOST_FIXTURE_TEST_CASE(pla_stream_header, teddy::tests::bdd_fixture)
+{
+    auto const path
+        = std::filesystem::temp_directory_path() / "libteddy-test.pla";
+    auto const open = [&path] (std::string const& content)
+    {
+        std::ofstream(path) << content;
+        auto stream = teddy::pla_stream::open_file(path.string());
+        std::filesystem::remove(path);
+        return stream;
+    };
+
+    BOOST_REQUIRE(not open(".i -2\n.o 1\n01 1\n.e\n").has_value());
+    BOOST_REQUIRE(not open(".i 2\n.o -1\n01 1\n.e\n").has_value());
+
+    // Vertical tab and form feed are whitespace too.
+    auto stream = open(".i\v2\n.o\f2\n.ob\ff\vg\n01\f11\n.e\n");
+    BOOST_REQUIRE(stream.has_value());
+    BOOST_REQUIRE_EQUAL(stream->get_variable_count(), 2);
+    BOOST_REQUIRE_EQUAL(stream->get_function_count(), 2);
+    BOOST_REQUIRE_EQUAL(stream->get_output_labels().size(), 2);
+    auto manager  = teddy::bdd_manager(2, 1'000);
+    auto diagrams = manager.from_pla(*stream);
+    BOOST_REQUIRE(diagrams.has_value());
+    auto const expected = manager.apply<ops::AND>(
+        manager.variable_not(0),
+        manager.variable(1)
+    );
+    BOOST_REQUIRE((*diagrams)[0].equals(expected));
+    BOOST_REQUIRE((*diagrams)[1].equals(expected));
+}
+
+BOOST_FIXTURE_TEST_CASE(dddmp, teddy::tests::bdd_fixture)
+{
+    auto expr1    = make_expression(expressionSettings_, rng_);
+    auto expr2    = make_expression(expressionSettings_, rng_);
+    auto manager  = make_manager(managerSettings_, rng_);
+    auto varCount = manager.get_var_count();
+    auto diagram1 = tsl::make_diagram(expr1, manager);
+    auto diagram2 = tsl::make_diagram(expr2, manager);
+    auto zero     = manager.constant(0);
+
+    // Round trip through the same manager.
+    auto ost = std::ostringstream();
+    manager.to_dddmp(ost, {diagram1, diagram2, zero});
+    auto ist  = std::istringstream(ost.str());
+    auto file = dddmp_file::load(ist);
+    BOOST_REQUIRE(file.has_value());
+    auto loaded1 = manager.from_dddmp(*file);
+    BOOST_REQUIRE(loaded1.has_value());
+    BOOST_REQUIRE_EQUAL(loaded1->size(), 3);
+    BOOST_REQUIRE((*loaded1)[0].equals(diagram1));
+    BOOST_REQUIRE((*loaded1)[1].equals(diagram2));
+    BOOST_REQUIRE((*loaded1)[2].equals(zero));
+
+    // Different order and variable mapping.
+    auto reversed = std::vector<int32>();
+    for (auto i = varCount - 1; i >= 0; --i)
+    {
+        reversed.push_back(i);
+    }
+    auto ids = std::vector<int32>();
+    for (auto i = 0; i < varCount; ++i)
+    {
+        ids.push_back(10 * i + 3);
+    }
+    auto mappedOst = std::ostringstream();
+    manager.to_dddmp(mappedOst, {diagram1}, ids);
+    auto mappedIst  = std::istringstream(mappedOst.str());
+    auto mappedFile = dddmp_file::load(mappedIst);
+    BOOST_REQUIRE(mappedFile.has_value());
+    BOOST_REQUIRE(not manager.from_dddmp(*mappedFile).has_value());
+    auto otherManager = bdd_manager(varCount, 1'000, reversed);
+    auto loaded2      = otherManager.from_dddmp(*mappedFile, ids);
+    BOOST_REQUIRE(loaded2.has_value());
+    auto valueDist = std::uniform_int_distribution<int32>(0, 1);
+    auto values    = std::vector<int32>(as_usize(varCount));
+    for (auto j = 0; j < 1'000; ++j)
+    {
+        for (auto& value : values)
+        {
+            value = valueDist(rng_);
+        }
+        BOOST_REQUIRE_EQUAL(
+            otherManager.evaluate((*loaded2)[0], values),
+            manager.evaluate(diagram1, values)
+        );
+    }
+
+    // File with complemented edges as written by CUDD, x0 AND x1 and NAND.
+    auto cuddIst = std::istringstream(
+        ".ver DDDMP-2.0\n"
+        ".mode A\n"
+        ".varinfo 0\n"
+        ".dd and\n"
+        ".nnodes 3\n"
+        ".nvars 2\n"
+        ".nsuppvars 2\n"
+        ".ids 0 1\n"
+        ".permids 0 1\n"
+        ".nroots 2\n"
+        ".rootids 3 -3\n"
+        ".nodes\n"
+        "1 T 1 0 0\n"
+        "2 1 1 1 -1\n"
+        "3 0 0 2 -1\n"
+        ".end\n"
+    );
+    auto cuddFile = dddmp_file::load(cuddIst);
+    BOOST_REQUIRE(cuddFile.has_value());
+    auto loaded3 = manager.from_dddmp(*cuddFile);
+    BOOST_REQUIRE(loaded3.has_value());
+    auto const conj = manager.apply<ops::AND>(
+        manager.variable(0),
+        manager.variable(1)
+    );
+    BOOST_REQUIRE((*loaded3)[0].equals(conj));
+    BOOST_REQUIRE((*loaded3)[1].equals(manager.negate(conj)));
+
+    // Round trip in the binary mode.
+    auto binaryOst = std::ostringstream(std::ios::binary);
+    manager.to_dddmp(
+        binaryOst,
+        {diagram1, diagram2, zero},
+        {},
+        dddmp_mode::Binary
+    );
+    auto binaryIst  = std::istringstream(binaryOst.str(), std::ios::binary);
+    auto binaryFile = dddmp_file::load(binaryIst);
+    BOOST_REQUIRE(binaryFile.has_value());
+    BOOST_REQUIRE_EQUAL(
+        binaryFile->get_nodes().size(),
+        file->get_nodes().size()
+    );
+    auto loaded4 = manager.from_dddmp(*binaryFile);
+    BOOST_REQUIRE(loaded4.has_value());
+    BOOST_REQUIRE_EQUAL(loaded4->size(), 3);
+    BOOST_REQUIRE((*loaded4)[0].equals(diagram1));
+    BOOST_REQUIRE((*loaded4)[1].equals(diagram2));
+    BOOST_REQUIRE((*loaded4)[2].equals(zero));
+
+    auto const path
+        = (std::filesystem::temp_directory_path() / "libteddy-test.dddmp")
+              .string();
+    std::ofstream(path, std::ios::binary) << binaryOst.str();
+    auto const binaryFromFile = dddmp_file::load_file(path);
+    std::filesystem::remove(path);
+    BOOST_REQUIRE(binaryFromFile.has_value());
+    auto loaded6 = manager.from_dddmp(*binaryFromFile);
+    BOOST_REQUIRE(loaded6.has_value());
+    BOOST_REQUIRE((*loaded6)[0].equals(diagram1));
+
+    // The same file as above in the binary mode. The leaf is escaped,
+    // both nodes use relative variables and sons.
+    auto const header = std::string(
+        ".ver DDDMP-2.0\n"
+        ".mode B\n"
+        ".varinfo 0\n"
+        ".nnodes 3\n"
+        ".nvars 2\n"
+        ".nsuppvars 2\n"
+        ".ids 0 1\n"
+        ".nroots 2\n"
+        ".rootids 3 -3\n"
+        ".nodes\n"
+    );
+    auto cuddBinaryIst = std::istringstream(
+        header + std::string("\x00\x00\x64\x7c", 4) + ".end\n"
+    );
+    auto cuddBinaryFile = dddmp_file::load(cuddBinaryIst);
+    BOOST_REQUIRE(cuddBinaryFile.has_value());
+    auto loaded5 = manager.from_dddmp(*cuddBinaryFile);
+    BOOST_REQUIRE(loaded5.has_value());
+    BOOST_REQUIRE((*loaded5)[0].equals(conj));
+    BOOST_REQUIRE((*loaded5)[1].equals(manager.negate(conj)));
+
+    // Truncated node table and INT_MIN son id are rejected.
+    auto truncatedIst = std::istringstream(
+        header + std::string("\x00\x00\x64", 3)
+    );
+    BOOST_REQUIRE(not dddmp_file::load(truncatedIst).has_value());
+    auto minIst = std::istringstream(
+        ".mode A\n"
+        ".nnodes 2\n"
+        ".nvars 1\n"
+        ".rootids 2\n"
+        ".nodes\n"
+        "1 T 1 0 0\n"
+        "2 0 1 -2147483648\n"
+        ".end\n"
+    );
+    BOOST_REQUIRE(not dddmp_file::load(minIst).has_value());
 }
 
 BOOST_AUTO_TEST_SUITE_END()
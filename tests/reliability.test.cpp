@@ -266,6 +266,20 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(probabilities, Fixture, Fixtures, Fixture)
             boost::test_tools::tolerance(FloatingTolerance)
         );
     }
+
+    auto const compiled = manager.compile(diagram);
+    for (auto j = 0; j < Fixture::stateCount_; ++j)
+    {
+        actual[as_uindex(j)] = compiled.calculate_probability(j, probs);
+    }
+
+    for (auto j = 0; j < Fixture::stateCount_; ++j)
+    {
+        BOOST_TEST(
+            actual[as_uindex(j)] == expected[as_uindex(j)],
+            boost::test_tools::tolerance(FloatingTolerance)
+        );
+    }
 }
 
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(availabilities, Fixture, Fixtures, Fixture)